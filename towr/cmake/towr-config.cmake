@@ -31,6 +31,7 @@
 #=============================================================================
 include(CMakeFindDependencyMacro)
 find_dependency(ifopt)
+find_dependency(Threads)
 
 # these are autogenerate by cmake
 include("${CMAKE_CURRENT_LIST_DIR}/towr-targets.cmake")
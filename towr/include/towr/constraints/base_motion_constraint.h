@@ -56,6 +56,11 @@ public:
   BaseMotionConstraint (double T, double dt, const SplineHolder& spline_holder);
   virtual ~BaseMotionConstraint () = default;
 
+  /**
+   * @brief Samples the base splines at all times at once.
+   */
+  VectorXd GetValues() const override;
+
   void UpdateConstraintAtInstance (double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance (double t, int k, VecBound&) const override;
   void UpdateJacobianAtInstance(double t, int k, std::string, Jacobian&) const override;
@@ -0,0 +1,71 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_CONSTRAINTS_CONSTANT_JACOBIAN_CONSTRAINT_H_
+#define TOWR_CONSTRAINTS_CONSTANT_JACOBIAN_CONSTRAINT_H_
+
+#include <map>
+#include <string>
+
+#include <ifopt/constraint_set.h>
+
+namespace towr {
+
+/**
+ * @brief A constraint set that is linear in the variables.
+ *
+ * The Jacobian of a linear set doesn't depend on the values of the variables,
+ * so it is filled by the wrapped set only once when linked with the variables
+ * and copied from then on. The values are still those of the wrapped set.
+ *
+ * @ingroup Constraints
+ */
+class ConstantJacobianConstraint : public ifopt::ConstraintSet {
+public:
+  /**
+   * @param constraint  The linear set, not yet linked with the variables.
+   */
+  ConstantJacobianConstraint (const ifopt::ConstraintSet::Ptr& constraint);
+  virtual ~ConstantJacobianConstraint () = default;
+
+  VectorXd GetValues() const override;
+  VecBound GetBounds() const override;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override;
+
+private:
+  ifopt::ConstraintSet::Ptr constraint_;
+  std::map<std::string, Jacobian> jacobians_; ///< for every variable set.
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_CONSTANT_JACOBIAN_CONSTRAINT_H_ */
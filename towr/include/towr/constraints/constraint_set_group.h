@@ -0,0 +1,89 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_CONSTRAINTS_CONSTRAINT_SET_GROUP_H_
+#define TOWR_CONSTRAINTS_CONSTRAINT_SET_GROUP_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <ifopt/constraint_set.h>
+
+#include <towr/thread_pool.h>
+
+namespace towr {
+
+/**
+ * @brief Evaluates independent constraint sets concurrently as a single set.
+ *
+ * The sets of e.g. the individual endeffectors don't share any mutable state,
+ * so their values and Jacobians can be computed at the same time on the
+ * threads of a pool. Every set writes into its own range of rows, which
+ * follow each other in the order the sets were given. Larger sets are
+ * started first, so the threads finish at about the same time.
+ *
+ * @ingroup Constraints
+ */
+class ConstraintSetGroup : public ifopt::ConstraintSet {
+public:
+  using ConstraintPtrVec = std::vector<ifopt::ConstraintSet::Ptr>;
+
+  /**
+   * @param constraints  The sets to evaluate, not yet linked with variables.
+   * @param pool  The threads to evaluate on, nullptr evaluates serially.
+   * @param name  The name of the combined constraint set.
+   */
+  ConstraintSetGroup (const ConstraintPtrVec& constraints,
+                      const ThreadPool::Ptr& pool,
+                      const std::string& name = "constraint-set-group");
+  virtual ~ConstraintSetGroup () = default;
+
+  VectorXd GetValues() const override;
+  VecBound GetBounds() const override;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override;
+
+  /** @brief The sets evaluated by this group, in order of their rows. */
+  const ConstraintPtrVec& GetConstraints() const { return constraints_; };
+
+private:
+  ConstraintPtrVec constraints_;
+  ThreadPool::Ptr thread_pool_;
+
+  std::vector<int> row_offsets_; ///< first row of each set.
+  std::vector<int> order_;       ///< in which the sets are handed to threads.
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+  void ForEachSet(const std::function<void(int i)>& f) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_CONSTRAINT_SET_GROUP_H_ */
@@ -74,15 +74,35 @@ public:
   DynamicConstraint (const DynamicModel::Ptr& model,
                      double T, double dt,
                      const SplineHolder& spline_holder);
+
+  /**
+   * @brief  Construct a Dynamic constraint at specific times.
+   * @param model  The system dynamics to enforce (e.g. centroidal, LIP, ...)
+   * @param dts  The times at which to enforce the constraints.
+   * @param spline_holder  A pointer to the current optimization variables.
+   */
+  DynamicConstraint (const DynamicModel::Ptr& model,
+                     const VecTimes& dts,
+                     const SplineHolder& spline_holder);
   virtual ~DynamicConstraint () = default;
 
+  /**
+   * @brief The dynamic violations at all times, computed in one sweep.
+   *
+   * Evaluates all samples at once through DynamicModel::GetDynamicViolations()
+   * instead of setting the model to every instance.
+   */
+  VectorXd GetValues() const override;
+
 private:
   NodeSpline::Ptr base_linear_;   ///< lin. base pos/vel/acc in world frame
-  EulerConverter base_angular_;        ///< angular base state
+  NodeSpline::Ptr base_euler_;    ///< Euler angles defining base_angular_
+  EulerConverter::Ptr base_angular_;   ///< angular base state
   std::vector<NodeSpline::Ptr> ee_forces_; ///< endeffector forces in world frame.
   std::vector<NodeSpline::Ptr> ee_motion_; ///< endeffector position in world frame.
 
-  mutable DynamicModel::Ptr model_;    ///< the dynamic model (e.g. Centroidal)
+  /// the dynamic model (e.g. Centroidal), one copy for every thread.
+  mutable std::vector<DynamicModel::Ptr> models_;
 
   /**
    * @brief The row in the overall constraint for this evaluation time.
@@ -92,11 +112,35 @@ private:
    */
   int GetRow(int k, Dim6D dimension) const;
 
+  /// The state and forces at all times in dts_, one column per time.
+  /// Sampled once and reused by the constraint values and all Jacobian
+  /// blocks, until the splines change.
+  mutable DynamicModel::Samples model_inputs_;
+  mutable int model_inputs_version_ = -1;
+
   /**
-   * @brief Updates the model with the current state and forces.
-   * @param t Time at which to query the state and force splines.
+   * @brief Resamples the model inputs if any of the splines changed.
    */
-  void UpdateModel(double t) const;
+  void UpdateModelInputs() const;
+
+  /**
+   * @returns A number that changes whenever any of the splines changes.
+   */
+  int GetSplinesVersion() const;
+
+  /**
+   * @brief The copy of the model that belongs to the calling thread.
+   */
+  DynamicModel& GetModel() const;
+
+  /**
+   * @brief Updates the model of the calling thread with the current state and forces.
+   * @param k The index of the constraint evaluation time in dts_.
+   * @returns The model of the calling thread.
+   */
+  const DynamicModel& UpdateModel(int k) const;
+
+  void PrepareEvaluation() const override;
 
   void UpdateConstraintAtInstance(double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance(double t, int k, VecBound& bounds) const override;
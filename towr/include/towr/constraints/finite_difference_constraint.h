@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_
+#define TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ifopt/constraint_set.h>
+
+#include <towr/thread_pool.h>
+#include <towr/variables/spline_holder.h>
+
+namespace towr {
+
+/**
+ * @brief Approximates the Jacobian of a constraint set by finite differences.
+ *
+ * Useful to prototype constraints before deriving their Jacobians, without
+ * switching the whole problem to numerical derivatives. The wrapped set
+ * only has to fill the structure of its Jacobian blocks, the values are
+ * ignored. The columns are grouped such that no two columns of a group have
+ * an entry in the same row (Curtis-Powell-Reid coloring), so all columns of
+ * a group are perturbed at once and one central difference per group
+ * recovers all their entries.
+ *
+ * The perturbed values are evaluated by copies of the set, each linked with
+ * its own copy of the variables, so the groups can be spread across the
+ * threads of a pool without touching the variables of the problem.
+ *
+ * @ingroup Constraints
+ */
+class FiniteDifferenceConstraint : public ifopt::ConstraintSet {
+public:
+  /**
+   * @brief A copy of the wrapped set, linked with its own variables.
+   */
+  struct Copy {
+    ifopt::ConstraintSet::Ptr constraint_; ///< not yet linked.
+    VariablesPtr variables_; ///< same sets and names as those of the problem.
+    SplineHolder splines_; ///< observe variables_, so kept alive with these.
+  };
+
+  /**
+   * @param constraint  The set to approximate the Jacobian of.
+   * @param copies  One for every thread of @a pool, or a single one.
+   * @param pool  The threads to evaluate on, nullptr evaluates serially.
+   */
+  FiniteDifferenceConstraint (const ifopt::ConstraintSet::Ptr& constraint,
+                              const std::vector<Copy>& copies,
+                              const ThreadPool::Ptr& pool);
+  virtual ~FiniteDifferenceConstraint () = default;
+
+  VectorXd GetValues() const override;
+  VecBound GetBounds() const override;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override;
+
+private:
+  /**
+   * @brief The structure of one Jacobian block and its column groups.
+   */
+  struct Pattern {
+    std::vector<int> col_begin_; ///< rows_ of column j start at col_begin_[j].
+    std::vector<int> rows_;
+    std::vector<int> group_begin_; ///< group_cols_ of group g start here.
+    std::vector<int> group_cols_;
+  };
+
+  ifopt::ConstraintSet::Ptr constraint_;
+  std::vector<Copy> copies_;
+  ThreadPool::Ptr thread_pool_;
+  std::map<std::string, Pattern> patterns_; ///< for every variable set.
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+  Pattern GetPattern(const std::string& var_set, int n_cols) const;
+  void SetCopyVariables(const Copy& copy) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_ */
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes_variables_phase_based.h>
 #include <towr/terrain/height_map.h> // for friction cone
+#include <towr/terrain/terrain_frames.h>
 
 namespace towr {
 
@@ -89,6 +90,10 @@ private:
    * stance phases, while all the others are already set to zero force (swing)
    **/
   std::vector<int> pure_stance_force_node_ids_;
+
+  /// The node of the foothold position during each of the above.
+  std::vector<int> foothold_node_ids_;
+  TerrainFrames::Ptr terrain_frames_; ///< the terrain at each foothold.
 };
 
 } /* namespace towr */
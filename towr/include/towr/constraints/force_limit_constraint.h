@@ -0,0 +1,84 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_CONSTRAINTS_FORCE_LIMIT_CONSTRAINT_H_
+#define TOWR_CONSTRAINTS_FORCE_LIMIT_CONSTRAINT_H_
+
+#include <map>
+#include <vector>
+
+#include <ifopt/constraint_set.h>
+
+#include <towr/variables/nodes_variables_phase_based.h>
+
+namespace towr {
+
+/**
+ * @brief Limits the normal force of forces inside the friction pyramid.
+ *
+ * When the forces are parameterized by NodesVariablesEEForceCone, they are
+ * already unilateral and inside the friction pyramid through their bounds.
+ * What remains of the ForceConstraint is only the maximum normal force,
+ * which is linear in these variables.
+ *
+ * Attention: Constraint is enforced only at the spline nodes.
+ *
+ * @ingroup Constraints
+ */
+class ForceLimitConstraint : public ifopt::ConstraintSet {
+public:
+  using EE = uint;
+
+  /**
+   * @param force_limit_in_normal_direction  Maximum pushing force [N].
+   * @param endeffector_id Which endeffector force should be constrained.
+   */
+  ForceLimitConstraint (double force_limit_in_normal_direction,
+                        EE endeffector_id);
+  virtual ~ForceLimitConstraint () = default;
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+
+  VectorXd GetValues() const override;
+  VecBound GetBounds() const override;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override;
+
+private:
+  NodesVariablesEEForceCone::Ptr ee_force_; ///< the current foot forces.
+  double fn_max_; ///< force limit in normal direction.
+  EE ee_;         ///< The endeffector force to be constrained.
+
+  std::vector<int> pure_stance_force_node_ids_;
+  std::map<int, int> row_; ///< of each of the above nodes.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_FORCE_LIMIT_CONSTRAINT_H_ */
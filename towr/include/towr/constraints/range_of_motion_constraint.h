@@ -50,6 +50,9 @@ namespace towr {
   * current CoM frame and constrains it to lie in a box around the nominal/
   * natural contact position for that leg.
   *
+  * A single set can constrain several endeffectors, which then share the
+  * base position and orientation evaluated at each time.
+  *
   * @ingroup Constraints
   */
 class RangeOfMotionConstraint : public TimeDiscretizationConstraint {
@@ -69,23 +72,62 @@ public:
                           double T, double dt,
                           const EE& ee,
                           const SplineHolder& spline_holder);
+
+  /**
+   * @brief Constructs a constraint instance at specific times.
+   * @param robot_model   The kinematic restrictions of the robot.
+   * @param dts  The times at which to enforce the constraints.
+   * @param ee            The endeffector for which to constrain the range.
+   * @param spline_holder Pointer to the current variables.
+   */
+  RangeOfMotionConstraint(const KinematicModel::Ptr& robot_model,
+                          const VecTimes& dts,
+                          const EE& ee,
+                          const SplineHolder& spline_holder);
+
+  /**
+   * @brief Constructs a constraint named "rangeofmotion" for several endeffectors at once.
+   * @param robot_model   The kinematic restrictions of the robot.
+   * @param dts  The times at which to enforce the constraints.
+   * @param ees  The endeffectors for which to constrain the range.
+   * @param spline_holder Pointer to the current variables.
+   */
+  RangeOfMotionConstraint(const KinematicModel::Ptr& robot_model,
+                          const VecTimes& dts,
+                          const std::vector<EE>& ees,
+                          const SplineHolder& spline_holder);
   virtual ~RangeOfMotionConstraint() = default;
 
+  /**
+   * @brief Samples the base and endeffector positions at all times at once.
+   */
+  VectorXd GetValues() const override;
+
 private:
   NodeSpline::Ptr base_linear_;     ///< the linear position of the base.
-  EulerConverter base_angular_; ///< the orientation of the base.
-  NodeSpline::Ptr ee_motion_;       ///< the linear position of the endeffectors.
+  EulerConverter::Ptr base_angular_; ///< the orientation of the base.
+
+  // for each of the constrained endeffectors
+  std::vector<EE> ees_;
+  std::vector<NodeSpline::Ptr> ee_motion_; ///< the linear position.
+  std::vector<Vector3d> nominal_ee_pos_B_;
 
   Eigen::Vector3d max_deviation_from_nominal_;
-  Eigen::Vector3d nominal_ee_pos_B_;
-  EE ee_;
+
+  /// The constructors above, differing only in the name of the set.
+  RangeOfMotionConstraint(const KinematicModel::Ptr& robot_model,
+                          const VecTimes& dts,
+                          const std::vector<EE>& ees,
+                          const SplineHolder& spline_holder,
+                          const std::string& name);
 
   // see TimeDiscretizationConstraint for documentation
   void UpdateConstraintAtInstance (double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance (double t, int k, VecBound&) const override;
   void UpdateJacobianAtInstance(double t, int k, std::string, Jacobian&) const override;
 
-  int GetRow(int node, int dimension) const;
+  /// The row of endeffector ees_[i] at time dts_[node].
+  int GetRow(int node, int i, int dimension) const;
 };
 
 } /* namespace towr */
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes_variables_phase_based.h>
 #include <towr/terrain/height_map.h>
+#include <towr/terrain/terrain_frames.h>
 
 namespace towr {
 
@@ -72,6 +73,7 @@ private:
 
   std::string ee_motion_id_;  ///< the name of the endeffector variable set.
   std::vector<int> node_ids_; ///< the indices of the nodes constrained.
+  TerrainFrames::Ptr terrain_frames_; ///< the terrain below these nodes.
 };
 
 } /* namespace towr */
@@ -30,11 +30,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_CONSTRAINTS_TIME_DISCRETIZATION_CONSTRAINT_H_
 #define TOWR_CONSTRAINTS_TIME_DISCRETIZATION_CONSTRAINT_H_
 
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
 #include <ifopt/constraint_set.h>
 
+#include <towr/thread_pool.h>
+
 namespace towr {
 
 /**
@@ -68,19 +72,68 @@ public:
   TimeDiscretizationConstraint (const VecTimes& dts, std::string name);
   virtual ~TimeDiscretizationConstraint () = default;
 
+  /**
+   * @brief The times 0, dt, 2dt, ... and T, without T twice.
+   */
+  static VecTimes GetUniformTimes(double T, double dt);
+
+  /**
+   * @brief Gauss-Lobatto collocation times within segments.
+   * @param segment_edges  The start and end times of the segments, e.g. of
+   *                       polynomials or contact phases, in any order.
+   * @param n_points  The number of points in each segment, at least 2.
+   * @return The sorted times, each edge time only once.
+   *
+   * The points of a segment include both its edges and are denser towards
+   * these, so edges closer together than 1e-6 are merged.
+   */
+  static VecTimes GetCollocationTimes(const VecTimes& segment_edges,
+                                      int n_points);
+
   Eigen::VectorXd GetValues() const override;
   VecBound GetBounds() const override;
   void FillJacobianBlock (std::string var_set, Jacobian&) const override;
 
+  /**
+   * @brief Evaluates the time instances in parallel on the threads of @a pool.
+   *
+   * Every thread fills the Jacobian rows of its instances into a separate
+   * matrix. These are merged in a fixed order, so the result doesn't depend
+   * on the number of threads.
+   */
+  void SetThreadPool(const ThreadPool::Ptr& pool);
+
 protected:
   int GetNumberOfNodes() const;
   VecTimes dts_; ///< times at which the constraint is evaluated.
 
+  /**
+   * @brief Calls f(t,k) for every time in dts_, in parallel if possible.
+   *
+   * Calls PrepareEvaluation() first. Calls of f with different k must only
+   * modify separate data.
+   */
+  void ForEachInstance(const std::function<void(double t, int k)>& f) const;
+
+  /** @brief The number of threads the instances may be evaluated on. */
+  int GetThreadCount() const;
+
 private:
+  ThreadPool::Ptr thread_pool_; ///< nullptr evaluates on the calling thread.
+
+  /**
+   * @brief Updates everything the instances share, before they are evaluated.
+   *
+   * Called from a single thread. Anything else the ..AtInstance() functions
+   * modify must be kept per thread, see ThreadPool::GetThreadIndex(), since
+   * these can be called from several threads at once.
+   */
+  virtual void PrepareEvaluation() const {};
+
   /**
    * @brief Sets the constraint value a specific time t, corresponding to node k.
    * @param t  The time along the trajectory to set the constraint.
-   * @param k  The index of the time t, so t=k*dt
+   * @param k  The index of the time t in dts_.
    * @param[in/out] g  The complete vector of constraint values, for which the
    *                   corresponding row must be filled.
    */
@@ -89,7 +142,7 @@ private:
   /**
    * @brief Sets upper/lower bound a specific time t, corresponding to node k.
    * @param t  The time along the trajectory to set the bounds.
-   * @param k  The index of the time t, so t=k*dt
+   * @param k  The index of the time t in dts_.
    * @param[in/out] b The complete vector of bounds, for which the corresponding
    *                  row must be set.
    */
@@ -98,13 +151,21 @@ private:
   /**
    * @brief Sets Jacobian rows at a specific time t, corresponding to node k.
    * @param t  The time along the trajcetory to set the bounds.
-   * @param k  The index of the time t, so t=k*dt
+   * @param k  The index of the time t in dts_.
    * @param var_set The name of the ifopt variables currently being queried for.
    * @param[in/out] jac  The complete Jacobian, for which the corresponding
    *                     row and columns must be set.
    */
   virtual void UpdateJacobianAtInstance(double t, int k, std::string var_set,
                                         Jacobian& jac) const = 0;
+
+  /**
+   * The nonzeros in each row of the Jacobian block of every variable set,
+   * as filled in the previous call. Since the sparsity structure never
+   * changes, this memory is reserved upfront, so the rows set at each
+   * instance are written into place instead of reallocating the matrix.
+   */
+  mutable std::map<std::string, Eigen::VectorXi> jac_row_nnz_;
 };
 
 } /* namespace towr */
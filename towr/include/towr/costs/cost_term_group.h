@@ -0,0 +1,80 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_COSTS_COST_TERM_GROUP_H_
+#define TOWR_COSTS_COST_TERM_GROUP_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <ifopt/cost_term.h>
+
+#include <towr/thread_pool.h>
+
+namespace towr {
+
+/**
+ * @brief Evaluates independent cost terms concurrently as a single term.
+ *
+ * The cost is the sum of all terms, the gradient the sum of their gradients.
+ * Each term is evaluated on one thread of the pool and the results are added
+ * up in the order the terms were given, so the sum doesn't depend on the
+ * number of threads.
+ *
+ * @ingroup Costs
+ */
+class CostTermGroup : public ifopt::CostTerm {
+public:
+  using CostPtrVec = std::vector<ifopt::ConstraintSet::Ptr>;
+
+  /**
+   * @param costs  The cost terms to evaluate, not yet linked with variables.
+   * @param pool   The threads to evaluate on, nullptr evaluates serially.
+   * @param name   The name of the combined cost term.
+   */
+  CostTermGroup (const CostPtrVec& costs, const ThreadPool::Ptr& pool,
+                 const std::string& name = "cost-term-group");
+  virtual ~CostTermGroup () = default;
+
+  double GetCost () const override;
+
+private:
+  CostPtrVec costs_;
+  ThreadPool::Ptr thread_pool_;
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+  void FillJacobianBlock(std::string var_set, Jacobian&) const override;
+  void ForEachTerm(const std::function<void(int i)>& f) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_COSTS_COST_TERM_GROUP_H_ */
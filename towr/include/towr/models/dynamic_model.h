@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_MODELS_DYNAMIC_MODEL_H_
 #define TOWR_MODELS_DYNAMIC_MODEL_H_
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -76,6 +77,38 @@ public:
   using EELoad   = EEPos;
   using EE       = uint;
 
+  /// Upper bound on the number of endeffectors, so the current endeffector
+  /// values can be stored without allocating memory. Models with more
+  /// endeffectors throw std::invalid_argument on construction.
+  static constexpr int kMaxEECount = 8;
+  using EEVectors = std::array<Eigen::Vector3d, kMaxEECount>;
+
+  /**
+   * @brief The state and input of the system at several samples.
+   *
+   * Every row holds one coordinate of all samples (structure of arrays), so
+   * the dynamics can be evaluated for consecutive samples at once with
+   * vector instructions.
+   */
+  struct Samples {
+    using Rows = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    /** @brief Sets the size for @a n samples, leaving the values undefined. */
+    void Resize(int n, int ee_count);
+    /** @brief The number of samples, one per column. */
+    int GetCount() const { return com_pos_.cols(); };
+
+    /** @brief The rotation matrix w_R_b of sample @a k. */
+    Matrix3d GetRotation(int k) const;
+    void SetRotation(int k, const Matrix3d& w_R_b);
+
+    Rows com_pos_, com_acc_;  ///< 3xn Center-of-Mass position/acceleration.
+    Rows w_R_b_;              ///< 9xn, row 3*i+j holds element (i,j) of w_R_b.
+    Rows omega_, omega_dot_;  ///< 3xn angular velocity/acceleration in world.
+    Rows ee_force_, ee_pos_;  ///< (3*ee_count)xn, row 3*ee+dim of each endeffector.
+  };
+  using BaseAccs = Eigen::Matrix<double, 6, Eigen::Dynamic>;
+
   /**
    * @brief Sets the current state and input of the system.
    * @param com_W        Current Center-of-Mass (x,y,z) position in world frame.
@@ -90,12 +123,38 @@ public:
                   const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
                   const EELoad& force_W, const EEPos& pos_W);
 
+  /**
+   * @brief Same as above, with the first GetEECount() elements of the
+   *        fixed-size arrays holding the endeffector forces and positions.
+   */
+  void SetCurrent(const ComPos& com_W, const Vector3d com_acc_W,
+                  const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
+                  const EEVectors& force_W, const EEVectors& pos_W);
+
+  /**
+   * @brief A copy of this model, e.g. to evaluate it on several threads.
+   *
+   * Only called when evaluating on more than one thread. Models that don't
+   * override this throw std::runtime_error then.
+   */
+  virtual Ptr Clone() const;
+
   /**
    * @brief  The violation of the system dynamics incurred by the current values.
    * @return The 6-dimension generalized force violation (angular + linear).
    */
   virtual BaseAcc GetDynamicViolation() const = 0;
 
+  /**
+   * @brief  The violation of the system dynamics at every sample.
+   * @return The 6xn dynamic violations, one column per sample.
+   *
+   * The default sets each sample as the current values in turn and
+   * calls GetDynamicViolation(), so the current values are changed. Models
+   * can override this to evaluate all samples in one sweep.
+   */
+  virtual BaseAccs GetDynamicViolations(const Samples& samples);
+
   /**
    * @brief How the base position affects the dynamic violation.
    * @param jac_base_lin_pos  The 3xn Jacobian of the base linear position.
@@ -138,6 +197,30 @@ public:
    */
   virtual Jac GetJacobianWrtEEPos(const Jac& ee_pos, EE ee) const = 0;
 
+  /**
+   * @brief Adds GetJacobianWrtBaseLin() to the 6 rows of @a jac starting at @a row.
+   *
+   * The Fill..() functions let models write their Jacobians directly into
+   * the rows of a larger matrix. The default implementations add the
+   * matrices returned by the above functions, models can override them to
+   * avoid these intermediate matrices.
+   */
+  virtual void FillJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
+                                      const Jac& jac_base_lin_acc,
+                                      int row, Jac& jac) const;
+
+  /** @brief Adds GetJacobianWrtBaseAng() to the 6 rows of @a jac starting at @a row. */
+  virtual void FillJacobianWrtBaseAng(const EulerConverter& base_angular,
+                                      double t, int row, Jac& jac) const;
+
+  /** @brief Adds GetJacobianWrtForce() to the 6 rows of @a jac starting at @a row. */
+  virtual void FillJacobianWrtForce(const Jac& ee_force, EE ee,
+                                    int row, Jac& jac) const;
+
+  /** @brief Adds GetJacobianWrtEEPos() to the 6 rows of @a jac starting at @a row. */
+  virtual void FillJacobianWrtEEPos(const Jac& ee_pos, EE ee,
+                                    int row, Jac& jac) const;
+
   /**
    * @returns The gravity acceleration [m/s^2] (positive)
    */
@@ -151,7 +234,7 @@ public:
   /**
    * @brief the number of endeffectors that this robot has.
    */
-  int GetEECount() const { return ee_pos_.size(); };
+  int GetEECount() const { return ee_count_; };
 
 protected:
   ComPos com_pos_;   ///< x-y-z position of the Center-of-Mass.
@@ -161,8 +244,14 @@ protected:
   AngVel omega_;       ///< angular velocity expressed in world frame.
   Vector3d omega_dot_; ///< angular acceleration expressed in world frame.
 
-  EEPos  ee_pos_;   ///< The x-y-z position of each endeffector.
-  EELoad ee_force_; ///< The endeffector force expressed in world frame.
+  int ee_count_;        ///< The number of endeffectors used in the arrays.
+  EEVectors ee_pos_;    ///< The x-y-z position of each endeffector.
+  EEVectors ee_force_;  ///< The endeffector force expressed in world frame.
+
+  /**
+   * @brief Called after the state was set, to update values derived from it.
+   */
+  virtual void UpdateDerivedQuantities() {};
 
   /**
    * @brief Construct a dynamic object. Protected as this is abstract base class.
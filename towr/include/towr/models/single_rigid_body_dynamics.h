@@ -55,6 +55,8 @@ namespace towr {
  */
 class SingleRigidBodyDynamics : public DynamicModel {
 public:
+  using EEMatrices = std::array<Matrix3d, kMaxEECount>;
+
   /**
    * @brief Constructs a specific model.
    * @param mass         The mass of the robot.
@@ -78,8 +80,20 @@ public:
 
   virtual ~SingleRigidBodyDynamics () = default;
 
+  /**
+   * Returns a SingleRigidBodyDynamics, so derived classes that add more
+   * than the constructor arguments must override this.
+   */
+  Ptr Clone() const override;
+
   BaseAcc GetDynamicViolation() const override;
 
+  /**
+   * Evaluates all samples in one sweep, each operation applied to a
+   * whole row of samples at once. Doesn't change the current values.
+   */
+  BaseAccs GetDynamicViolations(const Samples& samples) override;
+
   Jac GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
                             const Jac& jac_acc_base_lin) const override;
   Jac GetJacobianWrtBaseAng(const EulerConverter& base_angular,
@@ -88,11 +102,38 @@ public:
 
   Jac GetJacobianWrtEEPos(const Jac& jac_ee_pos, EE) const override;
 
+  void FillJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
+                              const Jac& jac_acc_base_lin,
+                              int row, Jac& jac) const override;
+  void FillJacobianWrtBaseAng(const EulerConverter& base_angular,
+                              double t, int row, Jac& jac) const override;
+  void FillJacobianWrtForce(const Jac& jac_force, EE,
+                            int row, Jac& jac) const override;
+  void FillJacobianWrtEEPos(const Jac& jac_ee_pos, EE,
+                            int row, Jac& jac) const override;
+
+protected:
+  void UpdateDerivedQuantities() override;
+
 private:
   /** Inertia of entire robot around the CoM expressed in a frame anchored
    *  in the base.
    */
-  Eigen::SparseMatrix<double, Eigen::RowMajor> I_b;
+  Matrix3d I_b;
+
+  // Quantities derived once from the current state, shared by the
+  // dynamic violation and all Jacobians.
+  Matrix3d I_w_;        ///< inertia expressed in world frame.
+  Matrix3d R_I_b_;      ///< w_R_b*I_b.
+  Vector3d I_w_omega_;  ///< I_w*omega.
+  Vector3d f_sum_;      ///< sum of all endeffector forces.
+  Vector3d tau_sum_;    ///< sum of all torques created by these forces.
+  Matrix3d omega_x_;    ///< cross product matrix of omega.
+  Matrix3d omega_x_R_I_b_;        ///< omega_x*w_R_b*I_b.
+  Matrix3d omega_x_I_w_minus_I_w_omega_x_; ///< omega_x*I_w - [I_w*omega]_x.
+  Matrix3d f_sum_x_;    ///< cross product matrix of the summed force.
+  EEMatrices f_x_;      ///< cross product matrix of each force.
+  EEMatrices r_x_;      ///< of each vector from endeffector to CoM.
 };
 
 
@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/models/robot_model.h>
 #include <towr/terrain/height_map.h>
 #include <towr/parameters.h>
+#include <towr/thread_pool.h>
 
 namespace towr {
 
@@ -85,7 +86,7 @@ public:
    * @brief The ifopt variable sets that will be optimized over.
    * @param[in/out] builds fully-constructed splines from the variables.
    */
-  VariablePtrVec GetVariableSets(SplineHolder& spline_holder);
+  VariablePtrVec GetVariableSets(SplineHolder& spline_holder) const;
 
   /**
    * @brief The ifopt constraints that enforce feasible motions.
@@ -93,6 +94,17 @@ public:
    */
   ContraintPtrVec GetConstraints(const SplineHolder& spline_holder) const;
 
+  /**
+   * @brief True if the Jacobian of all equality (or all inequality) rows of
+   * the constraints is constant, as their sets are linear in the variables.
+   *
+   * The solver can then evaluate it only once, e.g. for IPOPT by setting
+   * "jac_c_constant" (or "jac_d_constant") to "yes". Call only once the
+   * constraints are linked with the variables, e.g. added to the problem.
+   */
+  static bool IsJacobianConstant(const ContraintPtrVec& constraints,
+                                 bool equalities);
+
   /** @brief The ifopt costs to tune the motion. */
   ContraintPtrVec GetCosts() const;
 
@@ -105,15 +117,24 @@ public:
   Parameters params_;
 
 private:
+  /// shared by all constraints, created on first use.
+  mutable ThreadPool::Ptr thread_pool_;
+  ThreadPool::Ptr GetThreadPool() const;
+
   // variables
   std::vector<NodesVariables::Ptr> MakeBaseVariables() const;
   std::vector<NodesVariablesPhaseBased::Ptr> MakeEndeffectorVariables() const;
-  std::vector<NodesVariablesPhaseBased::Ptr> MakeForceVariables() const;
+  std::vector<NodesVariablesPhaseBased::Ptr> MakeForceVariables(
+      const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion) const;
   std::vector<PhaseDurations::Ptr> MakeContactScheduleVariables() const;
 
   // constraints
   ContraintPtrVec GetConstraint(Parameters::ConstraintName name,
                                 const SplineHolder& splines) const;
+  bool IsLinear(Parameters::ConstraintName name) const;
+  ContraintPtrVec MakeFiniteDifferenceConstraint(Parameters::ConstraintName name,
+                                                 const SplineHolder& splines) const;
+  std::vector<double> GetConstraintTimes(double dt) const;
   ContraintPtrVec MakeDynamicConstraint(const SplineHolder& s) const;
   ContraintPtrVec MakeRangeOfMotionBoxConstraint(const SplineHolder& s) const;
   ContraintPtrVec MakeTotalTimeConstraint() const;
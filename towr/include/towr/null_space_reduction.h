@@ -0,0 +1,124 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_NULL_SPACE_REDUCTION_H_
+#define TOWR_NULL_SPACE_REDUCTION_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ifopt/variable_set.h>
+#include <ifopt/constraint_set.h>
+
+namespace towr {
+
+/**
+ * @brief Optimizes only over the null space of the linear equalities.
+ *
+ * Variables fixed by their bounds (e.g. the initial base state) and linear
+ * constraint sets with only equality rows (e.g. the swing and base
+ * acceleration constraints, see ConstantJacobianConstraint) are eliminated by
+ * expressing all variables as x = x0 + Z*y. The solver then only sees the
+ * remaining variables y and constraint rows, so every factorization is
+ * smaller.
+ *
+ * The equalities are eliminated one after another, each by a variable
+ * without bounds where possible. Bounds of eliminated variables that are not
+ * fixed become linear inequality rows. Sets inside a ConstraintSetGroup are
+ * never eliminated.
+ *
+ * The original variable sets always hold the x of the current y, so a
+ * SplineHolder built from them describes the current and final motion.
+ */
+class NullSpaceReduction {
+public:
+  using Ptr             = std::shared_ptr<NullSpaceReduction>;
+  using VectorXd        = Eigen::VectorXd;
+  using Jacobian        = ifopt::Component::Jacobian;
+  using VariablePtrVec  = std::vector<ifopt::VariableSet::Ptr>;
+  using ContraintPtrVec = std::vector<ifopt::ConstraintSet::Ptr>;
+  using MultiplierMap   = std::map<std::string, VectorXd>;
+
+  /**
+   * @param variables  The variables x, e.g. of NlpFormulation::GetVariableSets().
+   * @param constraints  The constraints on x, not yet linked with variables.
+   * @param costs  The costs on x, not yet linked with variables.
+   *
+   * Throws if the linear equalities are inconsistent with each other.
+   */
+  NullSpaceReduction (const VariablePtrVec& variables,
+                      const ContraintPtrVec& constraints,
+                      const ContraintPtrVec& costs);
+  virtual ~NullSpaceReduction () = default;
+
+  /** @brief The single variable set y to add to the problem. */
+  ifopt::VariableSet::Ptr GetVariables() const;
+
+  /** @brief The constraints that were not eliminated, on y. */
+  ContraintPtrVec GetConstraints() const;
+
+  /** @brief The costs on y. */
+  ContraintPtrVec GetCosts() const;
+
+  /** @brief The full variables x = x0 + Z*y. */
+  VectorXd GetFullVariables(const VectorXd& y) const;
+
+  /** @brief The basis Z of the null space, one column per element of y. */
+  const Jacobian& GetNullSpaceBasis() const { return Z_; };
+
+  /**
+   * @brief Recovers the multipliers of the eliminated equalities.
+   * @param grad  The gradient of the Lagrangian w.r.t. x without the
+   *              eliminated equalities, so the gradient of the costs plus
+   *              J^T*lambda of the remaining constraints and bounds.
+   * @return The least-squares multipliers of every eliminated constraint set
+   *         and, for every variable set, those of its fixed variables (zero
+   *         for all others).
+   */
+  MultiplierMap GetEliminatedMultipliers(const VectorXd& grad) const;
+
+private:
+  ifopt::Composite::Ptr x_; ///< the original variables.
+  VectorXd x0_;
+  Jacobian Z_;
+
+  ifopt::VariableSet::Ptr y_;
+  ContraintPtrVec constraints_;
+  ContraintPtrVec costs_;
+
+  std::vector<int> fixed_ids_; ///< the variables fixed by their bounds.
+  ContraintPtrVec eliminated_; ///< the eliminated linear equality sets.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_NULL_SPACE_REDUCTION_H_ */
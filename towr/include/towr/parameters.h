@@ -185,6 +185,42 @@ public:
   /// Interval at which the base motion constraint is enforced.
   double dt_constraint_base_motion_;
 
+  /**
+   * If at least 2, the dynamic and range of motion constraints are instead
+   * enforced at this many Gauss-Lobatto points within every segment between
+   * the GetCollocationSegmentEdges(), so also at every contact switch.
+   * The segments are deliberately the contact phases rather than the base
+   * polynomials: these don't start at the contact switches, where the
+   * dynamics change abruptly, and are many more. Long phases therefore
+   * need more points to match the resolution of the uniform
+   * dt_constraint_.. grids.
+   */
+  int collocation_points_per_segment_;
+
+  /// Number of threads the time-discretized constraints are evaluated on.
+  int n_threads_;
+
+  /**
+   * Evaluates the constraint sets concurrently with each other on the
+   * n_threads_, and the same for the costs. These are then passed to the
+   * solver as a single constraint set and a single cost term.
+   */
+  bool evaluate_sets_in_parallel_;
+
+  /**
+   * Which of the constraints_ approximate their Jacobians by finite
+   * differences instead of the analytic derivatives, e.g. to check or
+   * prototype them. The Jacobian structure is still taken from the set.
+   */
+  UsedConstraints finite_difference_constraints_;
+
+  /**
+   * Solves only over the null space of the fixed variables and the linear
+   * equality constraints, see NullSpaceReduction. Not used by NlpFormulation
+   * itself, but by whoever builds the problem from it.
+   */
+  bool reduce_null_space_;
+
   /// Fixed duration of each cubic polynomial describing the base motion.
   double duration_base_polynomial_;
 
@@ -197,6 +233,14 @@ public:
   /// The maximum allowable force [N] in normal direction
   double force_limit_in_normal_direction_;
 
+  /**
+   * Parameterizes the stance forces by NodesVariablesEEForceCone, so they are
+   * unilateral and inside the friction pyramid through their bounds. The
+   * Force constraint then only limits the normal force. Requires a terrain
+   * with constant normal, see HeightMap::IsNormalConstant().
+   */
+  bool force_in_friction_cone_basis_;
+
   /// which dimensions (x,y,z) of the final base state should be bounded
   std::vector<int> bounds_final_lin_pos_,
                    bounds_final_lin_vel_,
@@ -217,12 +261,18 @@ public:
   /// The durations of each base polynomial in the spline (lin+ang).
   VecTimes GetBasePolyDurations() const;
 
+  /// The start and end times of every contact phase of any endeffector.
+  VecTimes GetCollocationSegmentEdges() const;
+
   /// The number of phases allowed for endeffector ee.
   int GetPhaseCount(EEID ee) const;
 
   /// True if the phase durations should be optimized over.
   bool IsOptimizeTimings() const;
 
+  /// True if the Jacobian of constraint c is approximated by finite differences.
+  bool IsFiniteDifferenceConstraint(ConstraintName c) const;
+
   /// The number of endeffectors.
   int GetEECount() const;
 
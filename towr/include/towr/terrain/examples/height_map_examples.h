@@ -46,6 +46,7 @@ class FlatGround : public HeightMap {
 public:
   FlatGround(double height = 0.0);
   double GetHeight(double x, double y)  const override { return height_; };
+  bool IsNormalConstant() const override { return true; };
 
 private:
   double height_; // [m]
@@ -74,6 +75,7 @@ private:
 class Stairs : public HeightMap {
 public:
   double GetHeight(double x, double y) const override;
+  bool IsNormalConstant() const override { return true; };
 
 private:
   double first_step_start_  = 1.0;
@@ -127,11 +127,39 @@ public:
    */
   Vector3d GetDerivativeOfNormalizedBasisWrt(Direction direction, Dim2D dim,
                                              double x, double y) const;
+
+  /**
+   * @brief The terrain height, normal and tangents at one position and how
+   *        these change when moving in x or y.
+   */
+  struct Frame {
+    double height_;
+    double dheight_[k2D];     ///< derivative of the height w.r.t. x,y.
+    Vector3d basis_[3];       ///< the normalized vectors, see Direction.
+    Vector3d dbasis_[3][k2D]; ///< derivative of each basis_ w.r.t. x,y.
+  };
+
+  /**
+   * @brief All the information of the above queries at one position.
+   * @param x  The x position on the terrain.
+   * @param y  The y position on the terrain.
+   *
+   * Evaluates each height derivative only once, so prefer this when
+   * multiple vectors and their derivatives are needed at the same position.
+   */
+  Frame GetFrame(double x, double y) const;
+
   /**
    * @returns The constant friction coefficient over the whole terrain.
    */
   double GetFrictionCoeff() const { return friction_coeff_; };
 
+  /**
+   * @returns True if the terrain normal is the same at every 2D position,
+   *          e.g. flat or evenly sloped ground.
+   */
+  virtual bool IsNormalConstant() const { return false; };
+
 protected:
   double friction_coeff_ = 0.5;
 
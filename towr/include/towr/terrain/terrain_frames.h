@@ -0,0 +1,82 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_TERRAIN_TERRAIN_FRAMES_H_
+#define TOWR_TERRAIN_TERRAIN_FRAMES_H_
+
+#include <vector>
+
+#include <towr/terrain/height_map.h>
+#include <towr/variables/nodes_variables.h>
+
+namespace towr {
+
+/**
+ * @brief The terrain frame below each node of an endeffector motion.
+ *
+ * Nodes whose xy-position is the same optimization variable, such as the two
+ * nodes of a stance phase, share one frame. A frame is only queried from the
+ * terrain again once the xy-position of its nodes changed, so all values and
+ * derivatives of a constraint use one terrain query per foothold and
+ * iteration.
+ *
+ * Not thread-safe, so every constraint set keeps its own.
+ */
+class TerrainFrames {
+public:
+  using Ptr   = std::shared_ptr<TerrainFrames>;
+  using Frame = HeightMap::Frame;
+
+  /**
+   * @param terrain  The terrain to query.
+   * @param ee_motion  The nodes of the endeffector position.
+   */
+  TerrainFrames (const HeightMap::Ptr& terrain,
+                 const NodesVariables::Ptr& ee_motion);
+  virtual ~TerrainFrames () = default;
+
+  /**
+   * @returns The terrain frame at the current xy-position of node @a node_id.
+   */
+  const Frame& GetFrame(int node_id) const;
+
+private:
+  HeightMap::Ptr terrain_;
+  NodesVariables::Ptr ee_motion_;
+
+  std::vector<int> frame_ids_; ///< the frame of each node.
+  mutable std::vector<Frame> frames_;
+  mutable std::vector<Eigen::Vector2d> frame_xy_; ///< where frames_ was queried.
+  mutable std::vector<bool> frame_valid_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_TERRAIN_TERRAIN_FRAMES_H_ */
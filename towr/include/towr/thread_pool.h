@@ -0,0 +1,122 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#ifndef TOWR_THREAD_POOL_H_
+#define TOWR_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace towr {
+
+/**
+ * @brief A fixed set of threads that parallel loops are distributed across.
+ *
+ * The threads are started once on construction and wait for work, so
+ * evaluating e.g. a constraint in parallel doesn't create any threads.
+ * The thread calling ParallelFor() takes part in the work itself.
+ *
+ * Every thread of the pool has a fixed index, see GetThreadIndex(). This
+ * allows users to keep per-thread scratch objects, instead of sharing
+ * mutable state between threads.
+ *
+ * The index is stored per thread, not per pool, so all objects evaluated
+ * in parallel must share the same pool. Only one pool should therefore
+ * exist per process, as NlpFormulation::GetThreadPool() does.
+ */
+class ThreadPool {
+public:
+  using Ptr = std::shared_ptr<ThreadPool>;
+
+  /**
+   * @param n_threads  The total number of threads, including the caller.
+   */
+  explicit ThreadPool (int n_threads);
+  virtual ~ThreadPool ();
+
+  ThreadPool (const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Calls f(i) for every i in [0,n) and returns once all are done.
+   *
+   * The indices are handed out in chunks to whichever thread is free. Calls
+   * from inside a running loop (nested loops) are executed serially by the
+   * calling thread.
+   */
+  void ParallelFor (int n, const std::function<void(int)>& f);
+
+  /** @brief The number of threads, including the one calling ParallelFor(). */
+  int GetThreadCount () const;
+
+  /**
+   * @returns The index of the calling thread in [0, GetThreadCount()).
+   *
+   * Threads that are not part of any pool, e.g. the one calling
+   * ParallelFor(), have index 0. With several pools the indices of their
+   * threads overlap, see the class description.
+   */
+  static int GetThreadIndex ();
+
+  /**
+   * @returns True if called from inside a loop distributed across threads
+   * by ParallelFor(), where any further ParallelFor() is executed serially.
+   */
+  static bool IsInParallelLoop ();
+
+private:
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  bool stop_ = false;
+  bool running_ = false;
+  int generation_ = 0;  ///< increased for every new loop.
+  int busy_workers_ = 0;
+
+  // the loop currently being executed
+  const std::function<void(int)>* f_ = nullptr;
+  int n_ = 0;
+  int chunk_ = 1;
+  std::atomic<int> next_{0};
+
+  void WorkerLoop (int thread_index);
+  void RunChunks ();
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_THREAD_POOL_H_ */
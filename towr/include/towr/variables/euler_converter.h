@@ -31,6 +31,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_
 
 #include <array>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -69,6 +72,7 @@ public:
   using MatrixSXd   = Eigen::SparseMatrix<double, Eigen::RowMajor>;
   using Jacobian    = MatrixSXd;
   using JacRowMatrix = std::array<std::array<JacobianRow, k3D>, k3D>;
+  using Ptr = std::shared_ptr<EulerConverter>;
 
   EulerConverter () = default;
 
@@ -90,6 +94,10 @@ public:
   EulerConverter (const NodeSpline::Ptr& euler_angles);
   virtual ~EulerConverter () = default;
 
+  /** @brief Links to the same spline, but without any cached samples. */
+  EulerConverter (const EulerConverter& other);
+  EulerConverter& operator=(const EulerConverter& other);
+
   /**
    * @brief Converts the Euler angles at time t to a Quaternion.
    * @param t The current time in the euler angles spline.
@@ -107,6 +115,14 @@ public:
   /** @see GetRotationMatrixBaseToWorld(t)  */
   static MatrixSXd GetRotationMatrixBaseToWorld(const EulerAngles& xyz);
 
+  /**
+   * @brief The same rotation matrix as dense fixed-size matrix.
+   *
+   * Preferred wherever the matrix is only multiplied with vectors, as it
+   * avoids building the sparse matrix.
+   */
+  Eigen::Matrix3d GetRotationMatrixBaseToWorldDense(double t) const;
+
   /**
    * @brief Converts Euler angles and Euler rates to angular velocities.
    * @param t The current time in the euler angles spline.
@@ -161,51 +177,84 @@ private:
   // Internal calculations for the conversion from euler rates to angular
   // velocities and accelerations. These are done using the matrix M defined
   // here: http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf
+  // All kernels work on dense fixed-size matrices and receive the sine and
+  // cosine of the Euler angles, so these are only evaluated once per time.
+  /**
+   * @brief Rotation matrix from base to world.
+   * @param s  sine of the Euler angles (roll, pitch, yaw).
+   * @param c  cosine of the Euler angles (roll, pitch, yaw).
+   */
+  static Eigen::Matrix3d GetRotationMatrix(const Vector3d& s, const Vector3d& c);
+
   /**
    * @brief Matrix that maps euler rates to angular velocities in world.
    *
    * Make sure euler rates are ordered roll-pitch-yaw. They are however applied
    * in the order yaw-pitch-role to determine the angular velocities.
    */
-  static MatrixSXd GetM(const EulerAngles& xyz);
+  static Eigen::Matrix3d GetM(const Vector3d& s, const Vector3d& c);
 
   /**
    *  @brief time derivative of GetM()
    */
-  static MatrixSXd GetMdot(const EulerAngles& xyz, const EulerRates& xyz_d);
+  static Eigen::Matrix3d GetMdot(const Vector3d& s, const Vector3d& c,
+                                 const EulerRates& xyz_d);
 
   /**
-   *  @brief Derivative of the @a dim row of matrix M with respect to
-   *         the node values.
+   * @brief The quantities derived from the Euler angles at a specific time.
    *
-   *  @param dim  Which dimension of the angular acceleration is desired.
-   *  @returns    the Jacobian w.r.t the coefficients for each of the 3 rows
-   *              of the matrix stacked on top of each other.
+   * The values are computed together the first time they are queried and
+   * kept until the Euler-angle spline changes. The Jacobians are only
+   * computed on request.
    */
-  Jacobian GetDerivMwrtNodes(double t, Dim3D dim) const;
+  struct Sample {
+    std::mutex mutex_;  ///< held while values are (re)computed.
+    int version_ = -1;  ///< spline version the values were computed for.
+    FixedState<k3D> ori_; ///< Euler angles, rates and rate derivatives.
+    Vector3d sin_, cos_;  ///< of the Euler angles.
+    Eigen::Matrix3d w_R_b_, M_, Mdot_;
+    Vector3d w_, wd_;     ///< angular velocity and acceleration in world.
+
+    bool has_jac_ang_ = false, has_jac_R_ = false;
+    Jacobian jac_w_, jac_wd_;
+    JacRowMatrix jac_R_;
+  };
+  mutable std::map<double, Sample> samples_; ///< times queried since the spline changed.
+  mutable int samples_version_ = -1;  ///< spline version of the samples_.
+  mutable std::mutex samples_mutex_;  ///< guards insertion into samples_.
 
-  /** @brief Derivative of the @a dim row of the time derivative of M with
-   *         respect to the node values.
+  /**
+   * @returns The up-to-date values at time t.
    *
-   *  @param dim Which dimension of the angular acceleration is desired.
+   * Can be called from several threads at once. The returned values don't
+   * change until the Euler-angle spline changes, after which all samples
+   * are discarded, so the cache doesn't grow with every queried time.
    */
-  Jacobian GetDerivMdotwrtNodes(double t, Dim3D dim) const;
+  Sample& GetSample(double t) const;
 
   /** @brief matrix of derivatives of each cell w.r.t node values.
    *
    * This 2d-array has the same dimensions as the rotation matrix M_IB, but
    * each cell if filled with a row vector.
    */
-  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const;
+  const JacRowMatrix& GetDerivativeOfRotationMatrixWrtNodes(double t) const;
 
-  /** @see GetAngularAccelerationInWorld(t)  */
-  static Vector3d GetAngularAccelerationInWorld(State euler);
+  /**
+   * @brief Fills the Jacobians of angular velocity and acceleration.
+   *
+   * Both share the derivatives of M, so they are always computed together.
+   */
+  void CalcDerivOfAngVelAndAccWrtEulerNodes(double t, Sample& s) const;
 
-  /** @see GetAngularVelocityInWorld(t)  */
-  static Vector3d GetAngularVelocityInWorld(const EulerAngles& pos,
-                                            const EulerRates& vel);
+  /**
+   * @brief All nine derivatives of the rotation matrix in one pass.
+   */
+  JacRowMatrix CalcDerivativeOfRotationMatrixWrtNodes(double t, const Sample& s) const;
 
-  JacobianRow GetJac(double t, Dx deriv, Dim3D dim) const;
+  /**
+   * @brief The 3 rows of the Euler angle Jacobian w.r.t. the nodes.
+   */
+  std::array<JacobianRow, k3D> GetJacRows(double t, Dx deriv) const;
   Jacobian jac_wrt_nodes_structure_;
 };
 
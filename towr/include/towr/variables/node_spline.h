@@ -30,11 +30,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_SRC_NODE_SPLINE_H_
 #define TOWR_TOWR_SRC_NODE_SPLINE_H_
 
+#include <map>
 #include <memory>
+#include <vector>
 #include <Eigen/Sparse>
 
 #include "spline.h"
 #include "nodes_observer.h"
+#include "nodes_variables.h"
 
 namespace towr {
 
@@ -62,6 +65,8 @@ public:
 
   /**
    * @brief Called by subject to update the polynomials with new node values.
+   *
+   * Only the polynomials adjacent to the changed nodes are recomputed.
    */
   void UpdateNodes();
 
@@ -86,6 +91,54 @@ public:
    */
   Jacobian GetJacobianWrtNodes(int poly_id, double t_local, Dx dxdt) const;
 
+  /**
+   * @brief How the spline changes when the node values change, at many times.
+   * @param t_global  The times along the spline, ascending ones are fastest.
+   * @param dxdt  Whether the derivative of the pos, vel or acc is desired.
+   * @return the (k*p)xn Jacobian, where rows k*p to k*p+p-1 are the same as
+   *         GetJacobianWrtNodes(t_global[k], dxdt).
+   *
+   * All times falling into the same polynomial share its stencil of node
+   * variables, and the whole matrix is assembled in one go.
+   */
+  Jacobian GetJacobiansWrtNodes(const VecTimes& t_global, Dx dxdt) const;
+
+  /**
+   * @brief Adds the Jacobian w.r.t. nodes directly into rows of a larger matrix.
+   * @param t  The time along the spline at which the sensitivity is required.
+   * @param dxdt  Whether the derivative of the pos, vel or acc is desired.
+   * @param row  The first of the p rows in @a jac to add the Jacobian to.
+   * @param jac[in/out]  Matrix with one column per node variable.
+   *
+   * Same values and sparsity as GetJacobianWrtNodes(t, dxdt), but without
+   * creating an intermediate sparse matrix. If the rows of @a jac have memory
+   * reserved, no allocation happens at all.
+   */
+  void FillJacobianWrtNodes(double t, Dx dxdt, int row, Jacobian& jac) const;
+
+  /**
+   * @brief Adds M times the Jacobian w.r.t nodes into rows of a larger matrix.
+   * @param M  Dense matrix with p columns the Jacobian is premultiplied by.
+   *
+   * Same as jac.middleRows(row, M.rows()) += M*GetJacobianWrtNodes(t, dxdt),
+   * with the sparsity of a dense M, e.g. a rotation matrix.
+   */
+  void FillJacobianWrtNodes(double t, Dx dxdt,
+                            const Eigen::Ref<const Eigen::MatrixXd>& M,
+                            int row, Jacobian& jac) const;
+
+  /**
+   * @brief Computes the Jacobians at these times once, to be reused.
+   * @param t_global  The times at which GetJacobianWrtNodes(t, dxdt) is queried.
+   * @param dxdt  Whether the derivative of the pos, vel or acc is desired.
+   *
+   * As long as the polynomial durations don't change, the Jacobian w.r.t.
+   * the nodes only depends on the time, not on the node values. Constraints
+   * evaluated on a fixed time grid can therefore request them once, and
+   * every later query at exactly these times returns the stored matrix.
+   */
+  void PrecomputeJacobiansWrtNodes(const VecTimes& t_global, Dx dxdt);
+
   /**
    * @returns The number of node variables being optimized over.
    */
@@ -117,6 +170,47 @@ protected:
    */
   void FillJacobianWrtNodes (int poly_id, double t_local, Dx dxdt,
                              Jacobian& jac, bool fill_with_zeros) const;
+
+  /**
+   * @brief Discards the precomputed Jacobians, must be called when the
+   *        polynomial durations change.
+   */
+  void ClearPrecomputedJacobians();
+
+private:
+  /// Jacobians w.r.t. nodes for specific derivatives and global times.
+  std::map<std::pair<Dx,double>, Jacobian> jac_precomputed_;
+
+  /**
+   * @brief A node value of a polynomial set by an optimization variable.
+   */
+  struct StencilEntry {
+    int opt_idx_;               ///< column in the Jacobian.
+    NodesVariables::Side side_; ///< start or end node of the polynomial.
+    Dx deriv_;                  ///< pos or vel of that node.
+    int dim_;                   ///< row in the Jacobian.
+    double weight_;             ///< of the variable in that node value.
+  };
+
+  /**
+   * The optimization variables each polynomial depends on. Since a polynomial
+   * is only defined by its two nodes, these are usually at most 2*2*dim entries.
+   */
+  std::vector<std::vector<StencilEntry>> jac_stencils_;
+
+  void BuildJacobianStencils();
+
+  /**
+   * @brief Copies the current start and end node into polynomial @a poly_id.
+   */
+  void SetPolynomialNodes(int poly_id);
+
+  /**
+   * @brief Calls f(dim, col, val) for every element of the Jacobian
+   *        GetJacobianWrtNodes(t, dxdt), including the structural zeros.
+   */
+  template<typename F>
+  void ForEachJacobianElement(double t, Dx dxdt, F f) const;
 };
 
 } /* namespace towr */
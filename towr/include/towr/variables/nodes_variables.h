@@ -86,9 +86,10 @@ public:
     int id_;   ///< ID of the associated node (0 =< id < number of nodes in spline).
     Dx deriv_; ///< Derivative (pos,vel) of the node with that ID.
     int dim_;  ///< Dimension (x,y,z) of that derivative.
+    double weight_ = 1.0; ///< Change of the node value per change of the variable.
 
     NodeValueInfo() = default;
-    NodeValueInfo(int node_id, Dx deriv, int node_dim);
+    NodeValueInfo(int node_id, Dx deriv, int node_dim, double weight = 1.0);
     int operator==(const NodeValueInfo& right) const;
   };
 
@@ -98,18 +99,37 @@ public:
    * @return All node values affected by this optimization variable.
    *
    * This function determines which node values are optimized over, and which
-   * nodes values are set by the same optimization variable.
+   * nodes values are set by the same optimization variable. A node value
+   * affected by several variables is the sum of these times their weight_.
    *
-   * Reverse of GetOptIndex().
+   * Reverse of GetOptIndex(). Only queried once by BuildIndexTables(), all
+   * later lookups go through GetNodeValuesInfoView().
    */
   virtual std::vector<NodeValueInfo> GetNodeValuesInfo(int opt_idx) const = 0;
 
+  /**
+   * @brief The node values of one optimization variable, without copying them.
+   */
+  struct NodeValueInfoView {
+    const NodeValueInfo* begin() const { return begin_; };
+    const NodeValueInfo* end() const { return end_; };
+    const NodeValueInfo* begin_;
+    const NodeValueInfo* end_;
+  };
+
+  /**
+   * @brief Same as GetNodeValuesInfo(), but looked up in the precomputed table.
+   * @param opt_idx  The index (=row) of the optimization variable.
+   */
+  NodeValueInfoView GetNodeValuesInfoView(int opt_idx) const;
+
   /**
    * @brief Index in the optimization vector for a specific nodes' pos/vel.
    * @param nvi Description of node value we want to know the index for.
    * @return The position of this node value in the optimization variables.
    *
-   * Reverse of GetNodeInfoAtOptIndex().
+   * Reverse of GetNodeValuesInfo(), looked up in the precomputed table. If
+   * the node value is a weighted sum of several variables, the last of them.
    */
   int GetOptIndex(const NodeValueInfo& nvi) const;
   static const int NodeValueNotOptimized = -1;
@@ -143,8 +163,11 @@ public:
 
   /**
    * @returns All the nodes that can be used to reconstruct the spline.
+   *
+   * A reference to the nodes themselves, so only valid as long as this
+   * object exists. Bind it as a reference to avoid copying all nodes.
    */
-  const std::vector<Node> GetNodes() const;
+  const std::vector<Node>& GetNodes() const;
 
   /**
    * @returns the number of polynomials that can be built with these nodes.
@@ -157,6 +180,11 @@ public:
   const std::vector<Node> GetBoundaryNodes(int poly_id) const;
 
   enum Side {Start=0, End};
+  /**
+   * @returns the node on one side of polynomial "poly_id", without copying it.
+   */
+  const Node& GetBoundaryNode(int poly_id, Side side) const;
+
   /**
    * @brief The node ID that belongs to a specific side of a specific polynomial.
    * @param poly_id The ID of the polynomial within the spline.
@@ -175,6 +203,17 @@ public:
    */
   int GetDim() const;
 
+  /**
+   * @returns The IDs of the nodes whose values changed in the last
+   *          SetVariables(), i.e. the ones the observers were notified about.
+   */
+  const std::vector<int>& GetChangedNodeIds() const;
+
+  /**
+   * @returns A counter that increases every time the node values change.
+   */
+  int GetVersion() const;
+
   /**
    * @brief Sets nodes pos/vel equally spaced from initial to final position.
    * @param initial_val  value of the first node.
@@ -211,17 +250,61 @@ protected:
   NodesVariables (const std::string& variable_name);
   virtual ~NodesVariables () = default;
 
+  // the nodes are views of values_, so copies would refer to the original
+  NodesVariables (const NodesVariables&) = delete;
+  NodesVariables& operator=(const NodesVariables&) = delete;
+
   VecBound bounds_; ///< the bounds on the node values.
-  std::vector<Node> nodes_;
+  std::vector<Node> nodes_; ///< views of the values of each node in values_.
   int n_dim_;
 
+  /**
+   * @brief Creates @a n_nodes zero nodes of dimension @a n_dim.
+   */
+  void InitNodes(int n_nodes, int n_dim);
+
+  /**
+   * @brief Builds the tables between optimization variables and node values.
+   *
+   * Must be called by every subclass once the nodes and the number of
+   * optimization variables are set, as all lookups go through these tables.
+   */
+  void BuildIndexTables();
+
 private:
+  /// The pos and vel of all nodes, node after node. So the values of
+  /// (node, deriv, dim) are stored at GetValueIndex().
+  VectorXd values_;
+  int GetValueIndex(const NodeValueInfo& nvi) const;
+
+  /// True if the optimization variables are exactly values_, so these can
+  /// be copied as a whole instead of one by one.
+  bool values_are_variables_ = false;
+
+  /// True if some node values are the weighted sum of several variables, so
+  /// the variables can't be gathered from values_ but are kept in variables_.
+  bool values_are_sums_ = false;
+  VectorXd variables_;
+
+  /// The optimization index of every (node, deriv, dim), see GetOptIndex().
+  std::vector<int> opt_index_;
+
+  /// The node values of optimization variable idx are stored in
+  /// node_values_info_ from node_values_begin_[idx] to node_values_begin_[idx+1].
+  std::vector<int> node_values_begin_;
+  std::vector<NodeValueInfo> node_values_info_;
+  std::vector<int> value_index_; ///< in values_ of each of node_values_info_.
+
   /**
    * @brief Notifies the subscribed observers that the node values changes.
    */
   void UpdateObservers() const;
   std::vector<ObserverPtr> observers_;
 
+  std::vector<int> changed_node_ids_; ///< nodes changed by last SetVariables().
+  std::vector<bool> node_changed_;    ///< same as above, but flag per node.
+  int version_ = 0;
+
   /**
    * @brief Bounds a specific node variables.
    * @param node_id  The ID of the node to bound.
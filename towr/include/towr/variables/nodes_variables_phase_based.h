@@ -32,6 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "nodes_variables.h"
 
+#include <towr/terrain/height_map.h>
+
 namespace towr {
 
 /**
@@ -169,6 +171,10 @@ protected:
     return index_to_node_value_info_.at(idx);
   }
 
+  /**
+   * @brief Sets the number of optimization variables and builds the index
+   *        tables from index_to_node_value_info_.
+   */
   void SetNumberOfVariables(int n_variables);
 
 private:
@@ -214,6 +220,58 @@ public:
   OptIndexMap GetPhaseBasedEEParameterization ();
 };
 
+
+/**
+ * @brief Stance forces as nonnegative combinations of friction pyramid edges.
+ *
+ * Instead of the xyz-force, each stance node is a combination of the 4
+ * edges of the friction pyramid at the foothold. The weights are bounded
+ * to be positive, so every force node is unilateral and inside the same
+ * pyramid |f*t| <= mu*f*n the ForceConstraint enforces, without requiring
+ * any constraint rows. The normal force is simply the sum of these weights.
+ * The force derivatives remain plain xyz-values, since 4 edge weights would
+ * leave one direction of every 3D derivative undetermined.
+ *
+ * The pyramids are built at the footholds of the initial end-effector
+ * motion and stay fixed while the footholds are optimized. Therefore only
+ * terrain with a constant normal (HeightMap::IsNormalConstant()) is
+ * supported, where these pyramids are the same at every foothold.
+ */
+class NodesVariablesEEForceCone : public NodesVariablesEEForce {
+public:
+  using Ptr = std::shared_ptr<NodesVariablesEEForceCone>;
+  static constexpr int n_edges = 4;
+
+  /**
+   * @param terrain  The terrain normals and friction coefficient.
+   * @param ee_motion  The initial footholds of this end-effector.
+   *
+   * Throws std::invalid_argument if the terrain normal isn't constant.
+   */
+  NodesVariablesEEForceCone(int phase_count,
+                            bool is_in_contact_at_start,
+                            const std::string& name,
+                            int n_polys_in_changing_phase,
+                            const HeightMap::Ptr& terrain,
+                            const NodesVariablesPhaseBased::Ptr& ee_motion);
+  virtual ~NodesVariablesEEForceCone() = default;
+
+  /**
+   * @returns the terrain normal the pyramid of stance node node_id is built on.
+   */
+  const Eigen::Vector3d& GetNormal(int node_id) const;
+
+  /**
+   * @brief Sets all stance forces to fn along the terrain normal.
+   */
+  void SetNormalForce(double fn);
+
+private:
+  std::map<int, Eigen::Vector3d> normals_; ///< of each stance node.
+  OptIndexMap GetFrictionConeParameterization (const HeightMap::Ptr& terrain,
+                                               const NodesVariablesPhaseBased& ee_motion);
+};
+
 } /* namespace towr */
 
 #endif /* TOWR_VARIABLES_PHASE_NODES_H_ */
@@ -117,6 +117,11 @@ public:
    */
   bool IsContactPhase(double t) const;
 
+  /**
+   * @returns A counter that increases every time the durations change.
+   */
+  int GetVersion() const { return version_; }
+
 private:
   VecDurations durations_;
 
@@ -126,6 +131,7 @@ private:
 
   std::vector<PhaseDurationsObserver*> observers_;
   void UpdateObservers() const;
+  int version_ = 0;
 };
 
 } /* namespace towr */
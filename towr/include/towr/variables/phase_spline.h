@@ -30,6 +30,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_INCLUDE_TOWR_VARIABLES_PHASE_SPLINE_H_
 #define TOWR_TOWR_INCLUDE_TOWR_VARIABLES_PHASE_SPLINE_H_
 
+#include <atomic>
+#include <mutex>
+
 #include "node_spline.h"
 #include "phase_durations_observer.h"
 #include "nodes_variables_phase_based.h"
@@ -59,7 +62,11 @@ public:
   ~PhaseSpline() = default;
 
   /**
-   * @brief Called by subject to update polynomial durations when they changed.
+   * @brief Called by subject when the phase durations changed.
+   *
+   * Only marks the polynomial durations as outdated. The durations and
+   * coefficients are recomputed once on the next query of the spline, since
+   * the phase durations might be set multiple times before that.
    */
   void UpdatePolynomialDurations() override;
 
@@ -81,6 +88,11 @@ private:
   Eigen::VectorXd GetDerivativeOfPosWrtPhaseDuration (double t) const;
 
   NodesVariablesPhaseBased::Ptr phase_nodes_; // retain pointer for extended functionality
+
+  mutable std::atomic<bool> durations_outdated_{true};
+  mutable std::mutex update_mutex_; ///< so only one thread applies durations.
+  void UpdateIfOutdated() const override;
+  void ApplyPhaseDurations();
 };
 
 } /* namespace towr */
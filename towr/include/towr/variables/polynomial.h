@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_POLYNOMIAL_H_
 #define TOWR_VARIABLES_POLYNOMIAL_H_
 
+#include <cassert>
 #include <string>
 #include <vector>
 
@@ -79,6 +80,11 @@ public:
    */
   double GetDerivativeWrtCoeff(double t, Dx poly_deriv, Coefficients coeff) const;
 
+  /**
+   * @returns The number of dimensions of f(t), e.g. 3 for x,y,z.
+   */
+  int GetDim() const { return coeff_.front().rows(); }
+
 protected:
   std::vector<VectorXd> coeff_;
 
@@ -111,6 +117,25 @@ public:
   CubicHermitePolynomial(int dim);
   virtual ~CubicHermitePolynomial() = default;
 
+  using Polynomial::GetPoint;
+
+  /**
+   * @returns The state of the polynomial at local time t, without allocation.
+   *
+   * Evaluates the cubic in Horner form. @a Dim must match the dimension the
+   * polynomial was constructed with.
+   */
+  template<int Dim>
+  FixedState<Dim> GetPoint(double t) const;
+
+  /**
+   * @returns The coefficients A,B,C,D as the columns of a matrix.
+   *
+   * Multiplied with the columns [1 t t^2 t^3] this gives the polynomial
+   * values at many times t at once.
+   */
+  template<int Dim>
+  Eigen::Matrix<double,Dim,4> GetCoeffMatrix() const;
 
   /**
    * @brief  sets the total duration of the polynomial.
@@ -170,6 +195,32 @@ private:
   double GetDerivativeOfAccWrtEndNode(Dx node_deriv, double t_local) const;
 };
 
+
+template<int Dim>
+FixedState<Dim>
+CubicHermitePolynomial::GetPoint (double t) const
+{
+  assert(t >= 0.0);
+  assert(coeff_[A].size() == Dim);
+
+  FixedState<Dim> out;
+  out.at(kPos) = coeff_[A] + t*(coeff_[B] + t*(coeff_[C] + t*coeff_[D]));
+  out.at(kVel) = coeff_[B] + t*(2*coeff_[C] + (3*t)*coeff_[D]);
+  out.at(kAcc) = 2*coeff_[C] + (6*t)*coeff_[D];
+  return out;
+}
+
+template<int Dim>
+Eigen::Matrix<double,Dim,4>
+CubicHermitePolynomial::GetCoeffMatrix () const
+{
+  Eigen::Matrix<double,Dim,4> coeff(GetDim(), 4);
+  for (auto c : {A,B,C,D})
+    coeff.col(c) = coeff_[c];
+
+  return coeff;
+}
+
 } // namespace towr
 
 #endif // TOWR_VARIABLES_POLYNOMIAL_H_
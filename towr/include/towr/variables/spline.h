@@ -30,6 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_SPLINE_H_
 #define TOWR_VARIABLES_SPLINE_H_
 
+#include <atomic>
+#include <tuple>
 #include <vector>
 
 #include "polynomial.h"
@@ -63,6 +65,33 @@ public:
    */
   const State GetPoint(int poly_id, double t_local) const;
 
+  /**
+   * @brief Same as GetPoint(t), but for a spline of known dimension @a Dim.
+   *
+   * The returned state lives on the stack, so no memory is allocated. Use
+   * this when evaluating the spline often, e.g. spline->GetPoint<k3D>(t).
+   */
+  template<int Dim>
+  FixedState<Dim> GetPoint(double t) const;
+
+  /**
+   * @brief Same as GetPoint(poly_id, t_local) for a spline of dimension @a Dim.
+   */
+  template<int Dim>
+  FixedState<Dim> GetPoint(int poly_id, double t_local) const;
+
+  /**
+   * @returns The states of the spline at all times @a t_global at once.
+   * @param t_global  The times at which the state of the spline is desired.
+   *
+   * Column k of the returned matrices is the state at t_global[k]. The Hermite
+   * basis is evaluated for all times together, and all times falling into
+   * the same polynomial are multiplied with its coefficients in one matrix
+   * product. Ascending times are the fastest to look up.
+   */
+  template<int Dim = Eigen::Dynamic>
+  StateSamples<Dim> GetPoints(const VecTimes& t_global) const;
+
   /**
    * @returns The segment (e.g. phase, polynomial) at time t_global.
    * @param t_global  The global time in the spline.
@@ -85,24 +114,128 @@ public:
    */
   VecTimes GetPolyDurations() const;
 
+  /**
+   * @returns A counter that increases every time the polynomials change.
+   *
+   * Allows to cache values derived from the spline, e.g. per sample time.
+   */
+  int GetVersion() const;
+
 protected:
   VecPoly cubic_polys_; ///< the sequence of polynomials making up the spline.
 
   /**
    * @brief How much time of the current segment has passed at t_global.
    * @param t_global The global time [s] along the spline.
-   * @param d The durations of each segment.
    * @return The segment id and the time passed in this segment.
+   *
+   * The segment is found by a search in the cached end times of the
+   * polynomials, starting at the segment of the previous query. Since
+   * constraints mostly query the spline at increasing times, this is usually
+   * constant time, otherwise logarithmic in the number of polynomials.
    */
-  std::pair<int,double> GetLocalTime(double t_global, const VecTimes& d) const;
+  std::pair<int,double> GetLocalTime(double t_global) const;
+
+  /**
+   * @brief Sets the polynomial durations and updates the time index.
+   * @param durations  The duration [s] of each polynomial.
+   *
+   * Must be called every time the polynomial durations change.
+   */
+  void SetPolyDurations(const VecTimes& durations);
 
   /**
    * @brief Updates the cubic-Hermite polynomial coefficients using the
    *        currently set nodes values and durations.
    */
   void UpdatePolynomialCoeff();
+
+  /**
+   * @brief Updates only the coefficients of polynomial @a poly_id.
+   */
+  void UpdatePolynomialCoeff(int poly_id);
+
+  /**
+   * @brief Brings the polynomials up to date before they are queried.
+   *
+   * Splines whose polynomials depend on other changing variables can
+   * override this to defer the update until they are actually queried.
+   */
+  virtual void UpdateIfOutdated() const {};
+
+private:
+  VecTimes poly_end_times_; ///< global time at which each polynomial ends.
+  /// segment found in the previous lookup. Only a guess, so concurrent
+  /// lookups from several threads may overwrite each other.
+  mutable std::atomic<int> segment_hint_{0};
+  int version_ = 0; ///< increased every time the polynomials change.
 };
 
+
+template<int Dim>
+FixedState<Dim>
+Spline::GetPoint (double t_global) const
+{
+  int id; double t_local;
+  std::tie(id, t_local) = GetLocalTime(t_global);
+
+  return GetPoint<Dim>(id, t_local);
+}
+
+template<int Dim>
+FixedState<Dim>
+Spline::GetPoint (int poly_id, double t_local) const
+{
+  UpdateIfOutdated();
+  return cubic_polys_.at(poly_id).GetPoint<Dim>(t_local);
+}
+
+template<int Dim>
+StateSamples<Dim>
+Spline::GetPoints (const VecTimes& t_global) const
+{
+  int n = t_global.size();
+  StateSamples<Dim> out(cubic_polys_.front().GetDim(), n);
+
+  std::vector<int> ids(n);
+  Eigen::Array<double,1,Eigen::Dynamic> t(n);
+  for (int k=0; k<n; ++k)
+    std::tie(ids[k], t[k]) = GetLocalTime(t_global[k]);
+
+  // columns [1 t t^2 t^3] and their time derivatives
+  Eigen::Matrix<double,4,Eigen::Dynamic> basis_p(4,n), basis_v(4,n), basis_a(4,n);
+  basis_p.row(0).setOnes();
+  basis_p.row(1) = t.matrix();
+  basis_p.row(2) = (t*t).matrix();
+  basis_p.row(3) = (t*t*t).matrix();
+
+  basis_v.row(0).setZero();
+  basis_v.row(1).setOnes();
+  basis_v.row(2) = (2*t).matrix();
+  basis_v.row(3) = (3*t*t).matrix();
+
+  basis_a.topRows(2).setZero();
+  basis_a.row(2).setConstant(2.0);
+  basis_a.row(3) = (6*t).matrix();
+
+  // every run of times in the same polynomial is one matrix product
+  int k = 0;
+  while (k < n) {
+    int n_run = 1;
+    while (k+n_run < n && ids[k+n_run] == ids[k])
+      n_run++;
+
+    auto coeff = cubic_polys_.at(ids[k]).template GetCoeffMatrix<Dim>();
+    out.at(kPos).middleCols(k, n_run).noalias() = coeff*basis_p.middleCols(k, n_run);
+    out.at(kVel).middleCols(k, n_run).noalias() = coeff*basis_v.middleCols(k, n_run);
+    out.at(kAcc).middleCols(k, n_run).noalias() = coeff*basis_a.middleCols(k, n_run);
+
+    k += n_run;
+  }
+
+  return out;
+}
+
 } /* namespace towr */
 
 #endif /* TOWR_VARIABLES_SPLINE_H_ */
@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "phase_durations.h"
 #include "node_spline.h"
+#include "euler_converter.h"
 #include "nodes_variables.h"
 #include "nodes_variables_phase_based.h"
 
@@ -71,6 +72,11 @@ struct SplineHolder {
   NodeSpline::Ptr base_linear_;
   NodeSpline::Ptr base_angular_;
 
+  /// Orientation, angular velocity/acceleration and their Jacobians derived
+  /// from base_angular_. Shared by all constraints, so each is computed only
+  /// once per sample time and node values.
+  EulerConverter::Ptr base_orientation_;
+
   std::vector<NodeSpline::Ptr> ee_motion_;
   std::vector<NodeSpline::Ptr> ee_force_;
   std::vector<PhaseDurations::Ptr> phase_durations_;
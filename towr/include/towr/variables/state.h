@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_STATE_H_
 #define TOWR_VARIABLES_STATE_H_
 
+#include <array>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -45,10 +46,16 @@ enum Dx { kPos=0, kVel, kAcc, kJerk };
  *
  * This state can represent a motion state with position, velocity and
  * accelerations, but also a force-profiles with forces, force-derivatives etc.
+ *
+ * All derivatives are stored consecutively in one block of memory. Usually
+ * the state owns this memory, but it can also be a view of values stored
+ * elsewhere (see Node). Copies of a state always own their values.
  */
 class State {
 public:
-  using VectorXd = Eigen::VectorXd;
+  using VectorXd       = Eigen::VectorXd;
+  using VectorMap      = Eigen::Map<VectorXd>;
+  using ConstVectorMap = Eigen::Map<const VectorXd>;
 
   /**
    * @brief Constructs a state object.
@@ -60,37 +67,141 @@ public:
   explicit State(int dim, int n_derivatives);
   virtual ~State() = default;
 
+  /**
+   * @brief Constructs a state that owns a copy of the values of @a other.
+   */
+  State(const State& other);
+
+  /**
+   * @brief Copies the values of @a other into the values of this state.
+   *
+   * If this state is a view, the values it refers to are overwritten, so
+   * the dimensions must match.
+   */
+  State& operator=(const State& other);
+
   /**
    * @brief   Read the state value or it's derivatives by index.
    * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
    * @return  Read-only n-dimensional position, velocity or acceleration.
+   *
+   * The returned map is a view of this state's values, so it is only valid
+   * as long as this state exists. For temporary states (e.g. returned by
+   * Spline::GetPoint()) the overloads below return owned copies instead.
    */
-  const VectorXd at(Dx deriv) const;
+  ConstVectorMap at(Dx deriv) const&;
+  VectorXd at(Dx deriv) const&&;
 
   /**
    * @brief   Read or write a specific state derivative by index.
    * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
    * @return  Read/write n-dimensional position, velocity or acceleration.
    */
-  VectorXd& at(Dx deriv);
+  VectorMap at(Dx deriv) &;
 
   /**
    * @brief read access to the zero-derivative of the state, e.g. position.
    */
-  const VectorXd p() const;
+  ConstVectorMap p() const&;
+  VectorXd p() const&&;
 
   /**
    * @brief read access to the first-derivative of the state, e.g. velocity.
    */
-  const VectorXd v() const;
+  ConstVectorMap v() const&;
+  VectorXd v() const&&;
 
   /**
    * @brief read access to the second-derivative of the state, e.g. acceleration.
    */
-  const VectorXd a() const;
+  ConstVectorMap a() const&;
+  VectorXd a() const&&;
+
+protected:
+  /**
+   * @brief Constructs a view of values stored elsewhere.
+   * @param data  The @a n_derivatives vectors of size @a dim stored consecutively.
+   */
+  State(double* data, int dim, int n_derivatives);
+
+private:
+  VectorXd owned_values_; ///< the values, unless this is a view.
+  double* values_;        ///< e.g. position, velocity and acceleration, ...
+  int dim_;
+  int n_derivatives_;
+};
+
+
+/**
+ * @brief A position, velocity and acceleration of compile-time dimension.
+ *
+ * Same as a State with three derivatives, but stored in fixed-size Eigen
+ * vectors, so it can be created and copied without any heap allocation.
+ * Used to query splines of known dimension (e.g. 3D) inside the constraints,
+ * which do this for every discretized time instance in every iteration.
+ */
+template<int Dim>
+class FixedState {
+public:
+  using Vector = Eigen::Matrix<double, Dim, 1>;
+  static const int n_derivatives = 3; ///< value, first and second derivative.
+
+  FixedState() { values_.fill(Vector::Zero()); }
+
+  /**
+   * @brief   Read the state value or it's derivatives by index.
+   * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
+   */
+  const Vector& at(Dx deriv) const { return values_[deriv]; }
+
+  /**
+   * @brief   Read or write a specific state derivative by index.
+   * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
+   */
+  Vector& at(Dx deriv) { return values_[deriv]; }
+
+  const Vector& p() const { return values_[kPos]; }
+  const Vector& v() const { return values_[kVel]; }
+  const Vector& a() const { return values_[kAcc]; }
+
+private:
+  std::array<Vector, n_derivatives> values_;
+};
+
+
+/**
+ * @brief Values and derivatives of a trajectory at a sequence of times.
+ *
+ * The structure-of-arrays counterpart of State: every derivative is one
+ * contiguous matrix with a column per time instance, e.g. p().col(k) is the
+ * position at the k-th time. @a Dim can be fixed (e.g. 3) or Eigen::Dynamic.
+ */
+template<int Dim = Eigen::Dynamic>
+class StateSamples {
+public:
+  using Matrix = Eigen::Matrix<double, Dim, Eigen::Dynamic>;
+  static const int n_derivatives = 3; ///< value, first and second derivative.
+
+  /**
+   * @param dim  The number of dimensions of each sample (e.g. x,y,z).
+   * @param n_samples  The number of time instances.
+   */
+  StateSamples(int dim, int n_samples)
+  {
+    values_.fill(Matrix::Zero(dim, n_samples));
+  }
+
+  const Matrix& at(Dx deriv) const { return values_[deriv]; }
+  Matrix& at(Dx deriv) { return values_[deriv]; }
+
+  const Matrix& p() const { return values_[kPos]; }
+  const Matrix& v() const { return values_[kVel]; }
+  const Matrix& a() const { return values_[kAcc]; }
+
+  int GetSampleCount() const { return values_[kPos].cols(); }
 
 private:
-  std::vector<VectorXd> values_; ///< e.g. position, velocity and acceleration, ...
+  std::array<Matrix, n_derivatives> values_;
 };
 
 
@@ -112,6 +223,14 @@ public:
    * @brief Constructs a @a dim - dimensional node (default zero-dimensional).
    */
   explicit Node(int dim = 0) : State(dim, n_derivatives) {};
+
+  /**
+   * @brief A view of a node whose position and velocity are stored at @a data.
+   *
+   * Used by NodesVariables to keep the values of all nodes in one
+   * contiguous vector.
+   */
+  Node(double* data, int dim) : State(data, dim, n_derivatives) {};
   virtual ~Node() = default;
 };
 
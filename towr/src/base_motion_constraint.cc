@@ -48,21 +48,41 @@ BaseMotionConstraint::BaseMotionConstraint (double T, double dt,
   node_bounds_.at(AY) = Bounds(-dev_rad, dev_rad);
   node_bounds_.at(AZ) = ifopt::NoBound;//Bounds(-dev_rad, dev_rad);
 
-  double z_init = base_linear_->GetPoint(0.0).p().z();
+  double z_init = base_linear_->GetPoint<k3D>(0.0).p().z();
   node_bounds_.at(LX) = ifopt::NoBound;
   node_bounds_.at(LY) = ifopt::NoBound;//Bounds(-0.05, 0.05);
   node_bounds_.at(LZ) = Bounds(z_init-0.02, z_init+0.1); // allow to move dev_z cm up and down
 
+  // with fixed durations these only depend on the time, so compute once
+  base_linear_->PrecomputeJacobiansWrtNodes(dts_, kPos);
+  base_angular_->PrecomputeJacobiansWrtNodes(dts_, kPos);
+
   int n_constraints_per_node = node_bounds_.size();
   SetRows(GetNumberOfNodes()*n_constraints_per_node);
 }
 
+BaseMotionConstraint::VectorXd
+BaseMotionConstraint::GetValues () const
+{
+  VectorXd g = VectorXd::Zero(GetRows());
+
+  auto lin = base_linear_->GetPoints<k3D>(dts_);
+  auto ang = base_angular_->GetPoints<k3D>(dts_);
+
+  for (int k=0; k<GetNumberOfNodes(); ++k) {
+    g.middleRows(GetRow(k, LX), k3D) = lin.p().col(k);
+    g.middleRows(GetRow(k, AX), k3D) = ang.p().col(k);
+  }
+
+  return g;
+}
+
 void
 BaseMotionConstraint::UpdateConstraintAtInstance (double t, int k,
                                                   VectorXd& g) const
 {
-  g.middleRows(GetRow(k, LX), k3D) = base_linear_->GetPoint(t).p();
-  g.middleRows(GetRow(k, AX), k3D) = base_angular_->GetPoint(t).p();
+  g.middleRows(GetRow(k, LX), k3D) = base_linear_->GetPoint<k3D>(t).p();
+  g.middleRows(GetRow(k, AX), k3D) = base_angular_->GetPoint<k3D>(t).p();
 }
 
 void
@@ -78,10 +98,10 @@ BaseMotionConstraint::UpdateJacobianAtInstance (double t, int k,
                                                 Jacobian& jac) const
 {
   if (var_set == id::base_ang_nodes)
-    jac.middleRows(GetRow(k,AX), k3D) = base_angular_->GetJacobianWrtNodes(t, kPos);
+    base_angular_->FillJacobianWrtNodes(t, kPos, GetRow(k,AX), jac);
 
   if (var_set == id::base_lin_nodes)
-    jac.middleRows(GetRow(k,LX), k3D) = base_linear_->GetJacobianWrtNodes(t, kPos);
+    base_linear_->FillJacobianWrtNodes(t, kPos, GetRow(k,LX), jac);
 }
 
 int
@@ -0,0 +1,77 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/constraints/constant_jacobian_constraint.h>
+
+namespace towr {
+
+
+ConstantJacobianConstraint::ConstantJacobianConstraint (
+    const ifopt::ConstraintSet::Ptr& constraint)
+    :ConstraintSet(kSpecifyLater, constraint->GetName())
+{
+  constraint_ = constraint;
+}
+
+void
+ConstantJacobianConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  constraint_->LinkWithVariables(x);
+  SetRows(constraint_->GetRows());
+
+  jacobians_.clear();
+  for (const auto& vars : x->GetComponents()) {
+    Jacobian jac(GetRows(), vars->GetRows());
+    constraint_->FillJacobianBlock(vars->GetName(), jac);
+    jac.makeCompressed();
+    jacobians_[vars->GetName()] = jac;
+  }
+}
+
+ConstantJacobianConstraint::VectorXd
+ConstantJacobianConstraint::GetValues () const
+{
+  return constraint_->GetValues();
+}
+
+ConstantJacobianConstraint::VecBound
+ConstantJacobianConstraint::GetBounds () const
+{
+  return constraint_->GetBounds();
+}
+
+void
+ConstantJacobianConstraint::FillJacobianBlock (std::string var_set,
+                                               Jacobian& jac) const
+{
+  jac = jacobians_.at(var_set);
+}
+
+} /* namespace towr */
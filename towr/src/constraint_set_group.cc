@@ -0,0 +1,129 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/constraints/constraint_set_group.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace towr {
+
+
+ConstraintSetGroup::ConstraintSetGroup (const ConstraintPtrVec& constraints,
+                                        const ThreadPool::Ptr& pool,
+                                        const std::string& name)
+    :ConstraintSet(kSpecifyLater, name)
+{
+  constraints_ = constraints;
+  thread_pool_ = pool;
+}
+
+void
+ConstraintSetGroup::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  // some sets only know their size once linked
+  int n_rows = 0;
+  row_offsets_.clear();
+  for (auto& c : constraints_) {
+    c->LinkWithVariables(x);
+    row_offsets_.push_back(n_rows);
+    n_rows += c->GetRows();
+  }
+  SetRows(n_rows);
+
+  order_.resize(constraints_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  std::stable_sort(order_.begin(), order_.end(), [&](int a, int b) {
+    return constraints_.at(a)->GetRows() > constraints_.at(b)->GetRows();
+  });
+}
+
+void
+ConstraintSetGroup::ForEachSet (const std::function<void(int i)>& f) const
+{
+  if (thread_pool_)
+    thread_pool_->ParallelFor(order_.size(), [&](int k) { f(order_.at(k)); });
+  else
+    for (int i=0; i<static_cast<int>(constraints_.size()); ++i)
+      f(i);
+}
+
+ConstraintSetGroup::VectorXd
+ConstraintSetGroup::GetValues () const
+{
+  VectorXd g(GetRows());
+
+  ForEachSet([&](int i) {
+    const auto& c = constraints_.at(i);
+    g.segment(row_offsets_.at(i), c->GetRows()) = c->GetValues();
+  });
+
+  return g;
+}
+
+ConstraintSetGroup::VecBound
+ConstraintSetGroup::GetBounds () const
+{
+  VecBound bounds;
+  bounds.reserve(GetRows());
+
+  for (const auto& c : constraints_) {
+    VecBound b = c->GetBounds();
+    bounds.insert(bounds.end(), b.begin(), b.end());
+  }
+
+  return bounds;
+}
+
+void
+ConstraintSetGroup::FillJacobianBlock (std::string var_set, Jacobian& jac) const
+{
+  std::vector<Jacobian> blocks(constraints_.size());
+
+  ForEachSet([&](int i) {
+    const auto& c = constraints_.at(i);
+    blocks.at(i).resize(c->GetRows(), jac.cols());
+    c->FillJacobianBlock(var_set, blocks.at(i));
+  });
+
+  // the blocks are stacked in order, so the rows can be appended one by one
+  Eigen::VectorXi row_nnz(jac.rows());
+  for (int i=0; i<static_cast<int>(blocks.size()); ++i)
+    for (int row=0; row<blocks.at(i).outerSize(); ++row)
+      row_nnz(row_offsets_.at(i)+row) = blocks.at(i).innerVector(row).nonZeros();
+  jac.reserve(row_nnz);
+
+  for (int i=0; i<static_cast<int>(blocks.size()); ++i)
+    for (int row=0; row<blocks.at(i).outerSize(); ++row)
+      for (Jacobian::InnerIterator it(blocks.at(i), row); it; ++it)
+        jac.insert(row_offsets_.at(i)+row, it.col()) = it.value();
+}
+
+} /* namespace towr */
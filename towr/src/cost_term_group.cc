@@ -0,0 +1,93 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/costs/cost_term_group.h>
+
+namespace towr {
+
+
+CostTermGroup::CostTermGroup (const CostPtrVec& costs,
+                              const ThreadPool::Ptr& pool,
+                              const std::string& name)
+    :CostTerm(name)
+{
+  costs_ = costs;
+  thread_pool_ = pool;
+}
+
+void
+CostTermGroup::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  for (auto& c : costs_)
+    c->LinkWithVariables(x);
+}
+
+void
+CostTermGroup::ForEachTerm (const std::function<void(int i)>& f) const
+{
+  if (thread_pool_)
+    thread_pool_->ParallelFor(costs_.size(), f);
+  else
+    for (int i=0; i<static_cast<int>(costs_.size()); ++i)
+      f(i);
+}
+
+double
+CostTermGroup::GetCost () const
+{
+  std::vector<double> costs(costs_.size());
+
+  ForEachTerm([&](int i) {
+    costs.at(i) = costs_.at(i)->GetValues()(0);
+  });
+
+  double cost = 0.0;
+  for (double c : costs)
+    cost += c;
+
+  return cost;
+}
+
+void
+CostTermGroup::FillJacobianBlock (std::string var_set, Jacobian& jac) const
+{
+  std::vector<Jacobian> gradients(costs_.size());
+
+  ForEachTerm([&](int i) {
+    gradients.at(i).resize(1, jac.cols());
+    costs_.at(i)->FillJacobianBlock(var_set, gradients.at(i));
+  });
+
+  for (const Jacobian& grad : gradients)
+    for (Jacobian::InnerIterator it(grad, 0); it; ++it)
+      jac.coeffRef(0, it.col()) += it.value();
+}
+
+} /* namespace towr */
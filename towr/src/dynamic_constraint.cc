@@ -37,16 +37,34 @@ namespace towr {
 DynamicConstraint::DynamicConstraint (const DynamicModel::Ptr& m,
                                       double T, double dt,
                                       const SplineHolder& spline_holder)
-    :TimeDiscretizationConstraint(T, dt, "dynamic")
+    :DynamicConstraint(m, GetUniformTimes(T, dt), spline_holder)
 {
-  model_ = m;
+}
+
+DynamicConstraint::DynamicConstraint (const DynamicModel::Ptr& m,
+                                      const VecTimes& dts,
+                                      const SplineHolder& spline_holder)
+    :TimeDiscretizationConstraint(dts, "dynamic")
+{
+  models_ = {m};
 
   // link with up-to-date spline variables
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
+  base_euler_   = spline_holder.base_angular_;
+  base_angular_ = spline_holder.base_orientation_;
   ee_forces_    = spline_holder.ee_force_;
   ee_motion_    = spline_holder.ee_motion_;
 
+  // with fixed durations these only depend on the time, so compute once
+  for (auto dxdt : {kPos, kAcc})
+    base_linear_->PrecomputeJacobiansWrtNodes(dts_, dxdt);
+  for (auto dxdt : {kPos, kVel, kAcc})
+    base_euler_->PrecomputeJacobiansWrtNodes(dts_, dxdt);
+  for (int ee=0; ee<static_cast<int>(ee_motion_.size()); ++ee) {
+    ee_forces_.at(ee)->PrecomputeJacobiansWrtNodes(dts_, kPos);
+    ee_motion_.at(ee)->PrecomputeJacobiansWrtNodes(dts_, kPos);
+  }
+
   SetRows(GetNumberOfNodes()*k6D);
 }
 
@@ -56,11 +74,21 @@ DynamicConstraint::GetRow (int k, Dim6D dimension) const
   return k6D*k + dimension;
 }
 
+DynamicConstraint::VectorXd
+DynamicConstraint::GetValues () const
+{
+  PrepareEvaluation();
+
+  // the rows of each instance follow each other, see GetRow()
+  DynamicModel& model = GetModel();
+  DynamicModel::BaseAccs g = model.GetDynamicViolations(model_inputs_);
+  return Eigen::Map<VectorXd>(g.data(), g.size());
+}
+
 void
 DynamicConstraint::UpdateConstraintAtInstance(double t, int k, VectorXd& g) const
 {
-  UpdateModel(t);
-  g.segment(GetRow(k,AX), k6D) = model_->GetDynamicViolation();
+  g.segment(GetRow(k,AX), k6D) = UpdateModel(k).GetDynamicViolation();
 }
 
 void
@@ -74,66 +102,116 @@ void
 DynamicConstraint::UpdateJacobianAtInstance(double t, int k, std::string var_set,
                                             Jacobian& jac) const
 {
-  UpdateModel(t);
-
-  int n = jac.cols();
-  Jacobian jac_model(k6D,n);
+  const DynamicModel& model = UpdateModel(k);
+  int row = GetRow(k,AX);
 
   // sensitivity of dynamic constraint w.r.t base variables.
   if (var_set == id::base_lin_nodes) {
     Jacobian jac_base_lin_pos = base_linear_->GetJacobianWrtNodes(t,kPos);
     Jacobian jac_base_lin_acc = base_linear_->GetJacobianWrtNodes(t,kAcc);
 
-    jac_model = model_->GetJacobianWrtBaseLin(jac_base_lin_pos,
-                                              jac_base_lin_acc);
+    model.FillJacobianWrtBaseLin(jac_base_lin_pos, jac_base_lin_acc, row, jac);
   }
 
   if (var_set == id::base_ang_nodes) {
-    jac_model = model_->GetJacobianWrtBaseAng(base_angular_, t);
+    model.FillJacobianWrtBaseAng(*base_angular_, t, row, jac);
   }
 
   // sensitivity of dynamic constraint w.r.t. endeffector variables
-  for (int ee=0; ee<model_->GetEECount(); ++ee) {
+  for (int ee=0; ee<model.GetEECount(); ++ee) {
     if (var_set == id::EEForceNodes(ee)) {
       Jacobian jac_ee_force = ee_forces_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtForce(jac_ee_force, ee);
+      model.FillJacobianWrtForce(jac_ee_force, ee, row, jac);
     }
 
     if (var_set == id::EEMotionNodes(ee)) {
       Jacobian jac_ee_pos = ee_motion_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtEEPos(jac_ee_pos, ee);
+      model.FillJacobianWrtEEPos(jac_ee_pos, ee, row, jac);
     }
 
     if (var_set == id::EESchedule(ee)) {
       Jacobian jac_f_dT = ee_forces_.at(ee)->GetJacobianOfPosWrtDurations(t);
-      jac_model += model_->GetJacobianWrtForce(jac_f_dT, ee);
+      model.FillJacobianWrtForce(jac_f_dT, ee, row, jac);
 
       Jacobian jac_x_dT = ee_motion_.at(ee)->GetJacobianOfPosWrtDurations(t);
-      jac_model +=  model_->GetJacobianWrtEEPos(jac_x_dT, ee);
+      model.FillJacobianWrtEEPos(jac_x_dT, ee, row, jac);
     }
   }
+}
+
+int
+DynamicConstraint::GetSplinesVersion () const
+{
+  // every version only ever increases, so does the sum
+  int version = base_linear_->GetVersion() + base_euler_->GetVersion();
+  for (int ee=0; ee<static_cast<int>(ee_motion_.size()); ++ee)
+    version += ee_forces_.at(ee)->GetVersion() + ee_motion_.at(ee)->GetVersion();
+
+  return version;
+}
+
+void
+DynamicConstraint::UpdateModelInputs () const
+{
+  int version = GetSplinesVersion();
+  if (version == model_inputs_version_)
+    return;
+
+  int n = dts_.size();
+  model_inputs_.Resize(n, ee_motion_.size());
+
+  auto com = base_linear_->GetPoints<k3D>(dts_);
+  model_inputs_.com_pos_ = com.p();
+  model_inputs_.com_acc_ = com.a();
+  for (int k=0; k<n; ++k) {
+    double t = dts_.at(k);
+    model_inputs_.SetRotation(k, base_angular_->GetRotationMatrixBaseToWorldDense(t));
+    model_inputs_.omega_.col(k)     = base_angular_->GetAngularVelocityInWorld(t);
+    model_inputs_.omega_dot_.col(k) = base_angular_->GetAngularAccelerationInWorld(t);
+  }
+
+  for (int ee=0; ee<static_cast<int>(ee_motion_.size()); ++ee) {
+    model_inputs_.ee_force_.middleRows(3*ee, k3D) = ee_forces_.at(ee)->GetPoints<k3D>(dts_).p();
+    model_inputs_.ee_pos_.middleRows(3*ee, k3D)   = ee_motion_.at(ee)->GetPoints<k3D>(dts_).p();
+  }
 
-  jac.middleRows(GetRow(k,AX), k6D) = jac_model;
+  model_inputs_version_ = version;
 }
 
 void
-DynamicConstraint::UpdateModel (double t) const
+DynamicConstraint::PrepareEvaluation () const
 {
-  auto com = base_linear_->GetPoint(t);
-
-  Eigen::Matrix3d w_R_b = base_angular_.GetRotationMatrixBaseToWorld(t);
-  Eigen::Vector3d omega = base_angular_.GetAngularVelocityInWorld(t);
-  Eigen::Vector3d omega_dot = base_angular_.GetAngularAccelerationInWorld(t);
-
-  int n_ee = model_->GetEECount();
-  std::vector<Eigen::Vector3d> ee_pos;
-  std::vector<Eigen::Vector3d> ee_force;
-  for (int ee=0; ee<n_ee; ++ee) {
-    ee_force.push_back(ee_forces_.at(ee)->GetPoint(t).p());
-    ee_pos.push_back(ee_motion_.at(ee)->GetPoint(t).p());
+  UpdateModelInputs();
+
+  // models are only copied when evaluating on several threads
+  while (static_cast<int>(models_.size()) < GetThreadCount())
+    models_.push_back(models_.front()->Clone());
+}
+
+DynamicModel&
+DynamicConstraint::GetModel () const
+{
+  int thread = GetThreadCount() > 1? ThreadPool::GetThreadIndex() : 0;
+  return *models_.at(thread);
+}
+
+const DynamicModel&
+DynamicConstraint::UpdateModel (int k) const
+{
+  DynamicModel& model = GetModel();
+
+  const DynamicModel::Samples& in = model_inputs_;
+  DynamicModel::EEVectors ee_force, ee_pos;
+  for (int ee=0; ee<model.GetEECount(); ++ee) {
+    ee_force.at(ee) = in.ee_force_.col(k).segment<k3D>(3*ee);
+    ee_pos.at(ee)   = in.ee_pos_.col(k).segment<k3D>(3*ee);
   }
 
-  model_->SetCurrent(com.p(), com.a(), w_R_b, omega, omega_dot, ee_force, ee_pos);
+  model.SetCurrent(in.com_pos_.col(k).matrix(), in.com_acc_.col(k).matrix(),
+                   in.GetRotation(k),
+                   in.omega_.col(k).matrix(), in.omega_dot_.col(k).matrix(),
+                   ee_force, ee_pos);
+  return model;
 }
 
 } /* namespace towr */
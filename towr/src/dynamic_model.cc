@@ -29,6 +29,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/models/dynamic_model.h>
 
+#include <algorithm> // std::copy
+#include <stdexcept>
+#include <string>
+
 namespace towr {
 
 DynamicModel::DynamicModel(double mass, int ee_count)
@@ -43,14 +47,42 @@ DynamicModel::DynamicModel(double mass, int ee_count)
   omega_.setZero();
   omega_dot_ .setZero();
 
-  ee_force_ = EELoad(ee_count);
-  ee_pos_ = EEPos(ee_count);
+  if (ee_count > kMaxEECount)
+    throw std::invalid_argument("DynamicModel: more than "
+                                + std::to_string(kMaxEECount) + " endeffectors");
+  ee_count_ = ee_count;
+  ee_force_.fill(Vector3d::Zero());
+  ee_pos_.fill(Vector3d::Zero());
+}
+
+DynamicModel::Ptr
+DynamicModel::Clone () const
+{
+  throw std::runtime_error("DynamicModel: Clone() not implemented, "
+                           "required for more than one thread");
 }
 
 void
 DynamicModel::SetCurrent (const ComPos& com_W, const Vector3d com_acc_W,
                           const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
                           const EELoad& force_W, const EEPos& pos_W)
+{
+  // the fixed-size storage must never be overrun, also without asserts
+  if (static_cast<int>(force_W.size()) != ee_count_
+      || static_cast<int>(pos_W.size()) != ee_count_)
+    throw std::invalid_argument("DynamicModel: wrong number of endeffectors");
+
+  EEVectors force, pos;
+  std::copy(force_W.begin(), force_W.end(), force.begin());
+  std::copy(pos_W.begin(), pos_W.end(), pos.begin());
+
+  SetCurrent(com_W, com_acc_W, w_R_b, omega_W, omega_dot_W, force, pos);
+}
+
+void
+DynamicModel::SetCurrent (const ComPos& com_W, const Vector3d com_acc_W,
+                          const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
+                          const EEVectors& force_W, const EEVectors& pos_W)
 {
   com_pos_   = com_W;
   com_acc_   = com_acc_W;
@@ -61,6 +93,99 @@ DynamicModel::SetCurrent (const ComPos& com_W, const Vector3d com_acc_W,
 
   ee_force_  = force_W;
   ee_pos_    = pos_W;
+
+  UpdateDerivedQuantities();
+}
+
+void
+DynamicModel::Samples::Resize (int n, int ee_count)
+{
+  com_pos_.resize(3, n);
+  com_acc_.resize(3, n);
+  w_R_b_.resize(9, n);
+  omega_.resize(3, n);
+  omega_dot_.resize(3, n);
+  ee_force_.resize(3*ee_count, n);
+  ee_pos_.resize(3*ee_count, n);
+}
+
+Eigen::Matrix3d
+DynamicModel::Samples::GetRotation (int k) const
+{
+  Matrix3d w_R_b;
+  for (int i=0; i<3; ++i)
+    for (int j=0; j<3; ++j)
+      w_R_b(i,j) = w_R_b_(3*i+j, k);
+
+  return w_R_b;
+}
+
+void
+DynamicModel::Samples::SetRotation (int k, const Matrix3d& w_R_b)
+{
+  for (int i=0; i<3; ++i)
+    for (int j=0; j<3; ++j)
+      w_R_b_(3*i+j, k) = w_R_b(i,j);
+}
+
+DynamicModel::BaseAccs
+DynamicModel::GetDynamicViolations (const Samples& s)
+{
+  BaseAccs acc(6, s.GetCount());
+
+  EEVectors force, pos;
+  for (int k=0; k<s.GetCount(); ++k) {
+    for (int ee=0; ee<ee_count_; ++ee) {
+      force.at(ee) = s.ee_force_.col(k).segment<3>(3*ee);
+      pos.at(ee)   = s.ee_pos_.col(k).segment<3>(3*ee);
+    }
+
+    SetCurrent(s.com_pos_.col(k).matrix(), s.com_acc_.col(k).matrix(),
+               s.GetRotation(k),
+               s.omega_.col(k).matrix(), s.omega_dot_.col(k).matrix(),
+               force, pos);
+    acc.col(k) = GetDynamicViolation();
+  }
+
+  return acc;
+}
+
+// adds the 6 rows of the block to the rows of jac starting at row
+static void
+AddRows (const DynamicModel::Jac& block, int row, DynamicModel::Jac& jac)
+{
+  for (int k=0; k<block.outerSize(); ++k)
+    for (DynamicModel::Jac::InnerIterator it(block,k); it; ++it)
+      jac.coeffRef(row+it.row(), it.col()) += it.value();
+}
+
+void
+DynamicModel::FillJacobianWrtBaseLin (const Jac& jac_base_lin_pos,
+                                      const Jac& jac_base_lin_acc,
+                                      int row, Jac& jac) const
+{
+  AddRows(GetJacobianWrtBaseLin(jac_base_lin_pos, jac_base_lin_acc), row, jac);
+}
+
+void
+DynamicModel::FillJacobianWrtBaseAng (const EulerConverter& base_angular,
+                                      double t, int row, Jac& jac) const
+{
+  AddRows(GetJacobianWrtBaseAng(base_angular, t), row, jac);
+}
+
+void
+DynamicModel::FillJacobianWrtForce (const Jac& ee_force, EE ee,
+                                    int row, Jac& jac) const
+{
+  AddRows(GetJacobianWrtForce(ee_force, ee), row, jac);
+}
+
+void
+DynamicModel::FillJacobianWrtEEPos (const Jac& ee_pos, EE ee,
+                                    int row, Jac& jac) const
+{
+  AddRows(GetJacobianWrtEEPos(ee_pos, ee), row, jac);
 }
 
 } /* namespace towr */
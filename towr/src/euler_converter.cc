@@ -31,9 +31,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace towr {
 
+// Entries of M that depend on the Euler angles, which are also the only
+// entries of Mdot that are not always zero. M(Z,Z)=1 completes M.
+static const std::array<std::vector<Dim3D>, k3D> kVaryingColsM = {{ {X,Y}, {X,Y}, {X} }};
+static const std::array<std::vector<Dim3D>, k3D> kColsM        = {{ {X,Y}, {X,Y}, {X,Z} }};
+
 
 EulerConverter::EulerConverter (const NodeSpline::Ptr& euler)
 {
@@ -41,189 +47,252 @@ EulerConverter::EulerConverter (const NodeSpline::Ptr& euler)
   jac_wrt_nodes_structure_ = Jacobian(k3D, euler->GetNodeVariablesCount());
 }
 
+EulerConverter::EulerConverter (const EulerConverter& other)
+{
+  *this = other;
+}
+
+EulerConverter&
+EulerConverter::operator= (const EulerConverter& other)
+{
+  if (this != &other) {
+    euler_ = other.euler_;
+    jac_wrt_nodes_structure_ = other.jac_wrt_nodes_structure_;
+
+    std::lock_guard<std::mutex> lock(samples_mutex_);
+    samples_.clear();
+    samples_version_ = -1;
+  }
+
+  return *this;
+}
+
 Eigen::Quaterniond
 EulerConverter::GetQuaternionBaseToWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetQuaternionBaseToWorld(ori.p());
+  return Eigen::Quaterniond(GetSample(t).w_R_b_);
 }
 
 Eigen::Quaterniond
 EulerConverter::GetQuaternionBaseToWorld (const EulerAngles& pos)
 {
-  Eigen::Matrix3d R_WB = GetRotationMatrixBaseToWorld(pos);
-  return Eigen::Quaterniond(R_WB);
+  Vector3d s = pos.array().sin();
+  Vector3d c = pos.array().cos();
+  return Eigen::Quaterniond(GetRotationMatrix(s, c));
 }
 
 Eigen::Vector3d
 EulerConverter::GetAngularVelocityInWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetAngularVelocityInWorld(ori.p(), ori.v());
-}
-
-Eigen::Vector3d
-EulerConverter::GetAngularVelocityInWorld (const EulerAngles& pos,
-                                           const EulerRates& vel)
-{
-  return GetM(pos)*vel;
+  return GetSample(t).w_;
 }
 
 Eigen::Vector3d
 EulerConverter::GetAngularAccelerationInWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetAngularAccelerationInWorld(ori);
+  return GetSample(t).wd_;
 }
 
-Eigen::Vector3d
-EulerConverter::GetAngularAccelerationInWorld (State ori)
+EulerConverter::Sample&
+EulerConverter::GetSample (double t) const
 {
-  return GetMdot(ori.p(), ori.v())*ori.v() + GetM(ori.p())*ori.a();
-}
+  Sample* sample;
+  {
+    std::lock_guard<std::mutex> lock(samples_mutex_);
+    int version = euler_->GetVersion();
+    if (samples_version_ != version) {
+      samples_.clear();
+      samples_version_ = version;
+    }
+    sample = &samples_[t]; // elements of a std::map never move
+  }
 
-EulerConverter::Jacobian
-EulerConverter::GetDerivOfAngVelWrtEulerNodes(double t) const
-{
-  Jacobian jac = jac_wrt_nodes_structure_;
+  Sample& s = *sample;
+  std::lock_guard<std::mutex> lock(s.mutex_);
 
-  State ori = euler_->GetPoint(t);
-  // convert to sparse, but also regard 0.0 as non-zero element, because
-  // could turn nonzero during the course of the program
-  JacobianRow vel = ori.v().transpose().sparseView(1.0, -1.0);
-  Jacobian dVel_du  = euler_->GetJacobianWrtNodes(t, kVel);
+  int version = euler_->GetVersion();
+  if (s.version_ != version) {
+    s.ori_ = euler_->GetPoint<k3D>(t);
+    s.sin_ = s.ori_.p().array().sin();
+    s.cos_ = s.ori_.p().array().cos();
 
-  for (auto dim : {X,Y,Z}) {
-    Jacobian dM_du = GetDerivMwrtNodes(t,dim);
-    jac.row(dim) = vel*dM_du + GetM(ori.p()).row(dim)*dVel_du;
+    s.w_R_b_ = GetRotationMatrix(s.sin_, s.cos_);
+    s.M_     = GetM(s.sin_, s.cos_);
+    s.Mdot_  = GetMdot(s.sin_, s.cos_, s.ori_.v());
+
+    s.w_  = s.M_*s.ori_.v();
+    s.wd_ = s.Mdot_*s.ori_.v() + s.M_*s.ori_.a();
+
+    s.has_jac_ang_ = s.has_jac_R_ = false;
+    s.version_ = version;
   }
 
-  return jac;
+  return s;
 }
 
 EulerConverter::Jacobian
-EulerConverter::GetDerivOfAngAccWrtEulerNodes (double t) const
+EulerConverter::GetDerivOfAngVelWrtEulerNodes (double t) const
 {
-  Jacobian jac = jac_wrt_nodes_structure_;
+  Sample& s = GetSample(t);
+  std::lock_guard<std::mutex> lock(s.mutex_);
+  if (!s.has_jac_ang_)
+    CalcDerivOfAngVelAndAccWrtEulerNodes(t, s);
 
+  return s.jac_w_;
+}
 
-  State ori = euler_->GetPoint(t);
-  // convert to sparse, but also regard 0.0 as non-zero element, because
-  // could turn nonzero during the course of the program
-  JacobianRow vel = ori.v().transpose().sparseView(1.0, -1.0);
-  JacobianRow acc = ori.a().transpose().sparseView(1.0, -1.0);
+EulerConverter::Jacobian
+EulerConverter::GetDerivOfAngAccWrtEulerNodes (double t) const
+{
+  Sample& s = GetSample(t);
+  std::lock_guard<std::mutex> lock(s.mutex_);
+  if (!s.has_jac_ang_)
+    CalcDerivOfAngVelAndAccWrtEulerNodes(t, s);
 
-  Jacobian dVel_du  = euler_->GetJacobianWrtNodes(t, kVel);
-  Jacobian dAcc_du  = euler_->GetJacobianWrtNodes(t, kAcc);
+  return s.jac_wd_;
+}
 
+const EulerConverter::JacRowMatrix&
+EulerConverter::GetDerivativeOfRotationMatrixWrtNodes (double t) const
+{
+  Sample& s = GetSample(t);
+  std::lock_guard<std::mutex> lock(s.mutex_);
+  if (!s.has_jac_R_) {
+    s.jac_R_ = CalcDerivativeOfRotationMatrixWrtNodes(t, s);
+    s.has_jac_R_ = true;
+  }
 
+  return s.jac_R_;
+}
+
+void
+EulerConverter::CalcDerivOfAngVelAndAccWrtEulerNodes(double t, Sample& s) const
+{
+  double sy = s.sin_(Y), cy = s.cos_(Y);
+  double sz = s.sin_(Z), cz = s.cos_(Z);
+  const Vector3d& vel = s.ori_.v();
+  const Vector3d& acc = s.ori_.a();
+  double yd = vel(Y);
+  double zd = vel(Z);
+
+  auto jac_pos = GetJacRows(t, kPos);
+  auto jac_vel = GetJacRows(t, kVel);
+  auto jac_acc = GetJacRows(t, kAcc);
+  const JacobianRow& jac_y  = jac_pos.at(Y);
+  const JacobianRow& jac_z  = jac_pos.at(Z);
+  const JacobianRow& jac_yd = jac_vel.at(Y);
+  const JacobianRow& jac_zd = jac_vel.at(Z);
+
+  // derivatives of the entries of M and Mdot that are not always zero
+  JacRowMatrix dM, dMdot;
+  dM.at(X).at(Y) = -cz*jac_z;
+  dM.at(X).at(X) = -cz*sy*jac_y - cy*sz*jac_z;
+  dM.at(Y).at(Y) = -sz*jac_z;
+  dM.at(Y).at(X) = cy*cz*jac_z - sy*sz*jac_y;
+  dM.at(Z).at(X) = -cy*jac_y;
+
+  dMdot.at(X).at(Y) = sz*zd*jac_z - cz*jac_zd;
+  dMdot.at(X).at(X) = (sy*sz*zd - cy*cz*yd)*jac_y + (sy*sz*yd - cy*cz*zd)*jac_z
+                      - cz*sy*jac_yd - cy*sz*jac_zd;
+  dMdot.at(Y).at(Y) = -sz*jac_zd - cz*zd*jac_z;
+  dMdot.at(Y).at(X) = -(cy*sz*yd + cz*sy*zd)*jac_y - (cz*sy*yd + cy*sz*zd)*jac_z
+                      + cy*cz*jac_zd - sy*sz*jac_yd;
+  dMdot.at(Z).at(X) = sy*yd*jac_y - cy*jac_yd;
+
+  // product rule on w = M*vel and wd = Mdot*vel + M*acc
+  int n = jac_wrt_nodes_structure_.cols();
+  s.jac_w_  = jac_wrt_nodes_structure_;
+  s.jac_wd_ = jac_wrt_nodes_structure_;
   for (auto dim : {X,Y,Z}) {
-    Jacobian dMdot_du = GetDerivMdotwrtNodes(t,dim);
-    Jacobian dM_du    = GetDerivMwrtNodes(t,dim);
+    JacobianRow w(n), wd(n);
 
-    jac.row(dim) = vel                               * dMdot_du
-                   + GetMdot(ori.p(), ori.v()).row(dim)* dVel_du
-                   + acc                             * dM_du
-                   + GetM(ori.p()).row(dim)           * dAcc_du;
+    for (auto c : kVaryingColsM.at(dim)) {
+      const JacobianRow& dM_du    = dM.at(dim).at(c);
+      const JacobianRow& dMdot_du = dMdot.at(dim).at(c);
+      w  += vel(c)*dM_du;
+      wd += vel(c)*dMdot_du + s.Mdot_(dim,c)*jac_vel.at(c) + acc(c)*dM_du;
+    }
+
+    for (auto c : kColsM.at(dim)) {
+      w  += s.M_(dim,c)*jac_vel.at(c);
+      wd += s.M_(dim,c)*jac_acc.at(c);
+    }
+
+    s.jac_w_.row(dim)  = w;
+    s.jac_wd_.row(dim) = wd;
   }
 
-  return jac;
+  s.has_jac_ang_ = true;
 }
 
-EulerConverter::MatrixSXd
-EulerConverter::GetM (const EulerAngles& xyz)
+Eigen::Matrix3d
+EulerConverter::GetM (const Vector3d& s, const Vector3d& c)
 {
-  double z = xyz(Z);
-  double y = xyz(Y);
-
   // Euler ZYX rates to angular velocity
   // http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf
-  Jacobian M(k3D, k3D);
-
-       /* - */           M.coeffRef(0,Y) = -sin(z);  M.coeffRef(0,X) =  cos(y)*cos(z);
-       /* - */           M.coeffRef(1,Y) =  cos(z);  M.coeffRef(1,X) =  cos(y)*sin(z);
-  M.coeffRef(2,Z) = 1.0;          /* - */            M.coeffRef(2,X) =  -sin(y);
+  Eigen::Matrix3d M;
+  M << c(Y)*c(Z), -s(Z), 0.0,
+       c(Y)*s(Z),  c(Z), 0.0,
+           -s(Y),   0.0, 1.0;
 
   return M;
 }
 
-EulerConverter::MatrixSXd
-EulerConverter::GetMdot (const EulerAngles& xyz,
+Eigen::Matrix3d
+EulerConverter::GetMdot (const Vector3d& s, const Vector3d& c,
                          const EulerRates& xyz_d)
 {
-  double z  = xyz(Z);
-  double zd = xyz_d(Z);
-  double y  = xyz(Y);
   double yd = xyz_d(Y);
+  double zd = xyz_d(Z);
 
-  Jacobian Mdot(k3D, k3D);
-
-  Mdot.coeffRef(0,Y) = -cos(z)*zd; Mdot.coeffRef(0,X) = -cos(z)*sin(y)*yd - cos(y)*sin(z)*zd;
-  Mdot.coeffRef(1,Y) = -sin(z)*zd; Mdot.coeffRef(1,X) =  cos(y)*cos(z)*zd - sin(y)*sin(z)*yd;
-              /* - */              Mdot.coeffRef(2,X) = -cos(y)*yd;
+  Eigen::Matrix3d Mdot;
+  Mdot << -c(Z)*s(Y)*yd - c(Y)*s(Z)*zd, -c(Z)*zd, 0.0,
+           c(Y)*c(Z)*zd - s(Y)*s(Z)*yd, -s(Z)*zd, 0.0,
+                            -c(Y)*yd,      0.0, 0.0;
 
- return Mdot;
+  return Mdot;
 }
 
-EulerConverter::Jacobian
-EulerConverter::GetDerivMwrtNodes (double t, Dim3D ang_acc_dim) const
+EulerConverter::MatrixSXd
+EulerConverter::GetRotationMatrixBaseToWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-
-  double z = ori.p()(Z);
-  double y = ori.p()(Y);
-  JacobianRow jac_z = GetJac(t, kPos, Z);
-  JacobianRow jac_y = GetJac(t, kPos, Y);
-
-  Jacobian jac = jac_wrt_nodes_structure_;
-
-  switch (ang_acc_dim) {
-    case X: // basically derivative of top row (3 elements) of matrix M
-      jac.row(Y) = -cos(z)*jac_z;
-      jac.row(X) = -cos(z)*sin(y)*jac_y - cos(y)*sin(z)*jac_z;
-      break;
-    case Y: // middle row of M
-      jac.row(Y) = -sin(z)*jac_z;
-      jac.row(X) = cos(y)*cos(z)*jac_z - sin(y)*sin(z)*jac_y;
-      break;
-    case Z: // bottom row of M
-      jac.row(X) = -cos(y)*jac_y;
-      break;
-    default:
-      assert(false);
-      break;
-  }
-
-  return jac;
+  return GetSample(t).w_R_b_.sparseView(1.0, -1.0);
 }
 
-EulerConverter::MatrixSXd
-EulerConverter::GetRotationMatrixBaseToWorld (double t) const
+Eigen::Matrix3d
+EulerConverter::GetRotationMatrixBaseToWorldDense (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetRotationMatrixBaseToWorld(ori.p());
+  return GetSample(t).w_R_b_;
 }
 
 EulerConverter::MatrixSXd
 EulerConverter::GetRotationMatrixBaseToWorld (const EulerAngles& xyz)
 {
-  double x = xyz(X);
-  double y = xyz(Y);
-  double z = xyz(Z);
+  Vector3d s = xyz.array().sin();
+  Vector3d c = xyz.array().cos();
+  return GetRotationMatrix(s, c).sparseView(1.0, -1.0);
+}
+
+Eigen::Matrix3d
+EulerConverter::GetRotationMatrix (const Vector3d& s, const Vector3d& c)
+{
+  double sx = s(X), cx = c(X);
+  double sy = s(Y), cy = c(Y);
+  double sz = s(Z), cz = c(Z);
 
   Eigen::Matrix3d M;
   //  http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf (Euler ZYX)
-  M << cos(y)*cos(z), cos(z)*sin(x)*sin(y) - cos(x)*sin(z), sin(x)*sin(z) + cos(x)*cos(z)*sin(y),
-       cos(y)*sin(z), cos(x)*cos(z) + sin(x)*sin(y)*sin(z), cos(x)*sin(y)*sin(z) - cos(z)*sin(x),
-             -sin(y),                        cos(y)*sin(x),                        cos(x)*cos(y);
+  M << cy*cz, cz*sx*sy - cx*sz, sx*sz + cx*cz*sy,
+       cy*sz, cx*cz + sx*sy*sz, cx*sy*sz - cz*sx,
+         -sy,            cy*sx,            cx*cy;
 
-  return M.sparseView(1.0, -1.0);
+  return M;
 }
 
 EulerConverter::Jacobian
 EulerConverter::DerivOfRotVecMult (double t, const Vector3d& v, bool inverse) const
 {
-  JacRowMatrix Rd = GetDerivativeOfRotationMatrixWrtNodes(t);
+  const JacRowMatrix& Rd = GetDerivativeOfRotationMatrixWrtNodes(t);
   Jacobian jac = jac_wrt_nodes_structure_;
 
   for (int row : {X,Y,Z}) {
@@ -239,74 +308,44 @@ EulerConverter::DerivOfRotVecMult (double t, const Vector3d& v, bool inverse) co
 }
 
 EulerConverter::JacRowMatrix
-EulerConverter::GetDerivativeOfRotationMatrixWrtNodes (double t) const
+EulerConverter::CalcDerivativeOfRotationMatrixWrtNodes (double t, const Sample& s) const
 {
   JacRowMatrix jac;
 
-  State ori = euler_->GetPoint(t);
-  double x = ori.p()(X);
-  double y = ori.p()(Y);
-  double z = ori.p()(Z);
+  double sx = s.sin_(X), cx = s.cos_(X);
+  double sy = s.sin_(Y), cy = s.cos_(Y);
+  double sz = s.sin_(Z), cz = s.cos_(Z);
 
-  JacobianRow jac_x = GetJac(t, kPos, X);
-  JacobianRow jac_y = GetJac(t, kPos, Y);
-  JacobianRow jac_z = GetJac(t, kPos, Z);
+  auto jac_pos = GetJacRows(t, kPos);
+  const JacobianRow& jac_x = jac_pos.at(X);
+  const JacobianRow& jac_y = jac_pos.at(Y);
+  const JacobianRow& jac_z = jac_pos.at(Z);
 
-  jac.at(X).at(X) = -cos(z)*sin(y)*jac_y - cos(y)*sin(z)*jac_z;
-  jac.at(X).at(Y) =  sin(x)*sin(z)*jac_x - cos(x)*cos(z)*jac_z - sin(x)*sin(y)*sin(z)*jac_z + cos(x)*cos(z)*sin(y)*jac_x + cos(y)*cos(z)*sin(x)*jac_y;
-  jac.at(X).at(Z) =  cos(x)*sin(z)*jac_x + cos(z)*sin(x)*jac_z - cos(z)*sin(x)*sin(y)*jac_x - cos(x)*sin(y)*sin(z)*jac_z + cos(x)*cos(y)*cos(z)*jac_y;
+  jac.at(X).at(X) = -cz*sy*jac_y - cy*sz*jac_z;
+  jac.at(X).at(Y) =  (sx*sz + cx*cz*sy)*jac_x + cy*cz*sx*jac_y - (cx*cz + sx*sy*sz)*jac_z;
+  jac.at(X).at(Z) =  (cx*sz - cz*sx*sy)*jac_x + cx*cy*cz*jac_y + (cz*sx - cx*sy*sz)*jac_z;
 
-  jac.at(Y).at(X) = cos(y)*cos(z)*jac_z - sin(y)*sin(z)*jac_y;
-  jac.at(Y).at(Y) = cos(x)*sin(y)*sin(z)*jac_x - cos(x)*sin(z)*jac_z - cos(z)*sin(x)*jac_x + cos(y)*sin(x)*sin(z)*jac_y + cos(z)*sin(x)*sin(y)*jac_z;
-  jac.at(Y).at(Z) = sin(x)*sin(z)*jac_z - cos(x)*cos(z)*jac_x - sin(x)*sin(y)*sin(z)*jac_x + cos(x)*cos(y)*sin(z)*jac_y + cos(x)*cos(z)*sin(y)*jac_z;
+  jac.at(Y).at(X) = cy*cz*jac_z - sy*sz*jac_y;
+  jac.at(Y).at(Y) = (cx*sy*sz - cz*sx)*jac_x + cy*sx*sz*jac_y + (cz*sx*sy - cx*sz)*jac_z;
+  jac.at(Y).at(Z) = (cx*cy*sz)*jac_y - (cx*cz + sx*sy*sz)*jac_x + (sx*sz + cx*cz*sy)*jac_z;
 
-  jac.at(Z).at(X) = -cos(y)*jac_y;
-  jac.at(Z).at(Y) =  cos(x)*cos(y)*jac_x - sin(x)*sin(y)*jac_y;
-  jac.at(Z).at(Z) = -cos(y)*sin(x)*jac_x - cos(x)*sin(y)*jac_y;
+  jac.at(Z).at(X) = -cy*jac_y;
+  jac.at(Z).at(Y) =  cx*cy*jac_x - sx*sy*jac_y;
+  jac.at(Z).at(Z) = -cy*sx*jac_x - cx*sy*jac_y;
 
   return jac;
 }
 
-EulerConverter::Jacobian
-EulerConverter::GetDerivMdotwrtNodes (double t, Dim3D ang_acc_dim) const
+std::array<EulerConverter::JacobianRow, k3D>
+EulerConverter::GetJacRows (double t, Dx deriv) const
 {
-  State ori = euler_->GetPoint(t);
-
-  double z  = ori.p()(Z);
-  double zd = ori.v()(Z);
-  double y  = ori.p()(Y);
-  double yd = ori.v()(Y);
-
-  JacobianRow jac_z  = GetJac(t, kPos, Z);
-  JacobianRow jac_y  = GetJac(t, kPos, Y);
-  JacobianRow jac_zd = GetJac(t, kVel, Z);
-  JacobianRow jac_yd = GetJac(t, kVel, Y);
+  Jacobian jac = euler_->GetJacobianWrtNodes(t, deriv);
 
-  Jacobian jac = jac_wrt_nodes_structure_;
-  switch (ang_acc_dim) {
-    case X: // derivative of top row (3 elements) of matrix M-dot
-      jac.row(Y) = sin(z)*zd*jac_z - cos(z)*jac_zd;
-      jac.row(X) = sin(y)*sin(z)*yd*jac_z - cos(y)*sin(z)*jac_zd - cos(y)*cos(z)*yd*jac_y - cos(y)*cos(z)*zd*jac_z - cos(z)*sin(y)*jac_yd + sin(y)*sin(z)*jac_y*zd;
-      break;
-    case Y: // middle row of M
-      jac.row(Y) = - sin(z)*jac_zd - cos(z)*zd*jac_z;
-      jac.row(X) = cos(y)*cos(z)*jac_zd - sin(y)*sin(z)*jac_yd - cos(y)*sin(z)*yd*jac_y - cos(z)*sin(y)*yd*jac_z - cos(z)*sin(y)*jac_y*zd - cos(y)*sin(z)*zd*jac_z;
-      break;
-    case Z: // bottom Row of M
-      jac.row(X) = sin(y)*yd*jac_y - cos(y)*jac_yd;
-      break;
-    default:
-      assert(false);
-      break;
-  }
+  std::array<JacobianRow, k3D> rows;
+  for (auto dim : {X,Y,Z})
+    rows.at(dim) = jac.row(dim);
 
-  return jac;
-}
-
-EulerConverter::JacobianRow
-EulerConverter::GetJac (double t, Dx deriv, Dim3D dim) const
-{
-  return euler_->GetJacobianWrtNodes(t, deriv).row(dim);
+  return rows;
 }
 
 } /* namespace towr */
@@ -0,0 +1,203 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/constraints/finite_difference_constraint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace towr {
+
+
+FiniteDifferenceConstraint::FiniteDifferenceConstraint (
+    const ifopt::ConstraintSet::Ptr& constraint,
+    const std::vector<Copy>& copies,
+    const ThreadPool::Ptr& pool)
+    :ConstraintSet(kSpecifyLater, constraint->GetName())
+{
+  constraint_  = constraint;
+  copies_      = copies;
+  thread_pool_ = pool;
+
+  assert(!copies_.empty());
+  assert(!thread_pool_ || static_cast<int>(copies_.size()) >= thread_pool_->GetThreadCount());
+}
+
+void
+FiniteDifferenceConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  constraint_->LinkWithVariables(x);
+  for (const auto& copy : copies_)
+    copy.constraint_->LinkWithVariables(copy.variables_);
+
+  SetRows(constraint_->GetRows());
+
+  patterns_.clear();
+  for (const auto& vars : x->GetComponents())
+    patterns_[vars->GetName()] = GetPattern(vars->GetName(), vars->GetRows());
+}
+
+FiniteDifferenceConstraint::Pattern
+FiniteDifferenceConstraint::GetPattern (const std::string& var_set,
+                                        int n_cols) const
+{
+  Jacobian jac(GetRows(), n_cols);
+  constraint_->FillJacobianBlock(var_set, jac);
+  jac.makeCompressed();
+
+  Eigen::SparseMatrix<double, Eigen::ColMajor> jac_cols = jac;
+  jac_cols.makeCompressed();
+
+  Pattern p;
+  p.col_begin_.assign(jac_cols.outerIndexPtr(), jac_cols.outerIndexPtr()+n_cols+1);
+  p.rows_.assign(jac_cols.innerIndexPtr(), jac_cols.innerIndexPtr()+jac_cols.nonZeros());
+
+  // greedily give every column the lowest group not yet taken by any
+  // column it shares a row with
+  std::vector<int> group(n_cols, -1);
+  std::vector<int> taken_by(n_cols, -1); ///< the last column that took a group.
+  int n_groups = 0;
+  for (int col=0; col<n_cols; ++col) {
+    if (p.col_begin_.at(col) == p.col_begin_.at(col+1))
+      continue; // doesn't need to be perturbed
+
+    for (int e=p.col_begin_.at(col); e<p.col_begin_.at(col+1); ++e)
+      for (Jacobian::InnerIterator it(jac, p.rows_.at(e)); it; ++it)
+        if (group.at(it.col()) != -1)
+          taken_by.at(group.at(it.col())) = col;
+
+    int g = 0;
+    while (taken_by.at(g) == col)
+      g++;
+
+    group.at(col) = g;
+    n_groups = std::max(n_groups, g+1);
+  }
+
+  p.group_begin_.assign(n_groups+1, 0);
+  for (int g : group)
+    if (g != -1)
+      p.group_begin_.at(g+1)++;
+  for (int g=0; g<n_groups; ++g)
+    p.group_begin_.at(g+1) += p.group_begin_.at(g);
+
+  p.group_cols_.resize(p.group_begin_.back());
+  std::vector<int> next(p.group_begin_.begin(), p.group_begin_.end()-1);
+  for (int col=0; col<n_cols; ++col)
+    if (group.at(col) != -1)
+      p.group_cols_.at(next.at(group.at(col))++) = col;
+
+  return p;
+}
+
+FiniteDifferenceConstraint::VectorXd
+FiniteDifferenceConstraint::GetValues () const
+{
+  return constraint_->GetValues();
+}
+
+FiniteDifferenceConstraint::VecBound
+FiniteDifferenceConstraint::GetBounds () const
+{
+  return constraint_->GetBounds();
+}
+
+void
+FiniteDifferenceConstraint::SetCopyVariables (const Copy& copy) const
+{
+  for (const auto& vars : GetVariables()->GetComponents())
+    copy.variables_->GetComponent(vars->GetName())->SetVariables(vars->GetValues());
+}
+
+void
+FiniteDifferenceConstraint::FillJacobianBlock (std::string var_set,
+                                               Jacobian& jac) const
+{
+  const Pattern& p = patterns_.at(var_set);
+  int n_groups = p.group_begin_.size()-1;
+  if (n_groups == 0)
+    return;
+
+  // balances truncation and rounding error of central differences
+  static const double step = std::cbrt(std::numeric_limits<double>::epsilon());
+  VectorXd x = GetVariables()->GetComponent(var_set)->GetValues();
+  VectorXd h = step*x.cwiseAbs().cwiseMax(1.0);
+
+  VectorXd values(p.rows_.size());
+  std::vector<char> copy_is_current(copies_.size(), false);
+
+  auto fill_group = [&](int g) {
+    int c = thread_pool_? ThreadPool::GetThreadIndex() : 0;
+    const Copy& copy = copies_.at(c);
+    if (!copy_is_current.at(c)) {
+      SetCopyVariables(copy);
+      copy_is_current.at(c) = true;
+    }
+
+    VectorXd dx = VectorXd::Zero(x.rows());
+    for (int k=p.group_begin_.at(g); k<p.group_begin_.at(g+1); ++k)
+      dx(p.group_cols_.at(k)) = h(p.group_cols_.at(k));
+
+    auto vars = copy.variables_->GetComponent(var_set);
+    vars->SetVariables(x + dx);
+    VectorXd g_plus = copy.constraint_->GetValues();
+    vars->SetVariables(x - dx);
+    VectorXd g_minus = copy.constraint_->GetValues();
+
+    // every row belongs to only one of the perturbed columns
+    for (int k=p.group_begin_.at(g); k<p.group_begin_.at(g+1); ++k) {
+      int col = p.group_cols_.at(k);
+      for (int e=p.col_begin_.at(col); e<p.col_begin_.at(col+1); ++e) {
+        int row = p.rows_.at(e);
+        values(e) = (g_plus(row) - g_minus(row))/(2*h(col));
+      }
+    }
+  };
+
+  if (thread_pool_)
+    thread_pool_->ParallelFor(n_groups, fill_group);
+  else
+    for (int g=0; g<n_groups; ++g)
+      fill_group(g);
+
+  Eigen::VectorXi row_nnz = Eigen::VectorXi::Zero(jac.rows());
+  for (int row : p.rows_)
+    row_nnz(row)++;
+  jac.reserve(row_nnz);
+
+  int n_cols = p.col_begin_.size()-1;
+  for (int col=0; col<n_cols; ++col)
+    for (int e=p.col_begin_.at(col); e<p.col_begin_.at(col+1); ++e)
+      jac.insert(p.rows_.at(e), col) = values(e);
+}
+
+} /* namespace towr */
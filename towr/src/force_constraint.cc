@@ -55,6 +55,15 @@ ForceConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
 
   pure_stance_force_node_ids_ = ee_force_->GetIndicesOfNonConstantNodes();
 
+  // foot position doesn't change during stance phase
+  foothold_node_ids_.clear();
+  for (int f_node_id : pure_stance_force_node_ids_) {
+    int phase = ee_force_->GetPhase(f_node_id);
+    foothold_node_ids_.push_back(ee_motion_->GetNodeIDAtStartOfPhase(phase));
+  }
+
+  terrain_frames_ = std::make_shared<TerrainFrames>(terrain_, ee_motion_);
+
   int constraint_count = pure_stance_force_node_ids_.size()*n_constraints_per_node_;
   SetRows(constraint_count);
 }
@@ -65,22 +74,21 @@ ForceConstraint::GetValues () const
   VectorXd g(GetRows());
 
   int row=0;
-  auto force_nodes = ee_force_->GetNodes();
-  for (int f_node_id : pure_stance_force_node_ids_) {
-    int phase  = ee_force_->GetPhase(f_node_id);
-    Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during stance phase
-    Vector3d n = terrain_->GetNormalizedBasis(HeightMap::Normal, p.x(), p.y());
-    Vector3d f = force_nodes.at(f_node_id).p();
+  const auto& force_nodes = ee_force_->GetNodes();
+  for (int i=0; i<static_cast<int>(pure_stance_force_node_ids_.size()); ++i) {
+    const auto& frame = terrain_frames_->GetFrame(foothold_node_ids_.at(i));
+    const Vector3d& n = frame.basis_[HeightMap::Normal];
+    Vector3d f = force_nodes.at(pure_stance_force_node_ids_.at(i)).p();
 
     // unilateral force
     g(row++) = f.transpose() * n; // >0 (unilateral forces)
 
     // frictional pyramid
-    Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
+    const Vector3d& t1 = frame.basis_[HeightMap::Tangent1];
     g(row++) = f.transpose() * (t1 - mu_*n); // t1 < mu*n
     g(row++) = f.transpose() * (t1 + mu_*n); // t1 > -mu*n
 
-    Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+    const Vector3d& t2 = frame.basis_[HeightMap::Tangent2];
     g(row++) = f.transpose() * (t2 - mu_*n); // t2 < mu*n
     g(row++) = f.transpose() * (t2 + mu_*n); // t2 > -mu*n
   }
@@ -110,13 +118,12 @@ ForceConstraint::FillJacobianBlock (std::string var_set,
 {
   if (var_set == ee_force_->GetName()) {
     int row = 0;
-    for (int f_node_id : pure_stance_force_node_ids_) {
-      // unilateral force
-      int phase   = ee_force_->GetPhase(f_node_id);
-      Vector3d p  = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during phase
-      Vector3d n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
-      Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
-      Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+    for (int i=0; i<static_cast<int>(pure_stance_force_node_ids_.size()); ++i) {
+      int f_node_id = pure_stance_force_node_ids_.at(i);
+      const auto& frame  = terrain_frames_->GetFrame(foothold_node_ids_.at(i));
+      const Vector3d& n  = frame.basis_[HeightMap::Normal];
+      const Vector3d& t1 = frame.basis_[HeightMap::Tangent1];
+      const Vector3d& t2 = frame.basis_[HeightMap::Tangent2];
 
       for (auto dim : {X,Y,Z}) {
         int idx = ee_force_->GetOptIndex(NodesVariables::NodeValueInfo(f_node_id, kPos, dim));
@@ -137,18 +144,16 @@ ForceConstraint::FillJacobianBlock (std::string var_set,
 
   if (var_set == ee_motion_->GetName()) {
     int row = 0;
-    auto force_nodes = ee_force_->GetNodes();
-    for (int f_node_id : pure_stance_force_node_ids_) {
-      int phase  = ee_force_->GetPhase(f_node_id);
-      int ee_node_id = ee_motion_->GetNodeIDAtStartOfPhase(phase);
-
-      Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during pahse
-      Vector3d f = force_nodes.at(f_node_id).p();
+    const auto& force_nodes = ee_force_->GetNodes();
+    for (int i=0; i<static_cast<int>(pure_stance_force_node_ids_.size()); ++i) {
+      int ee_node_id = foothold_node_ids_.at(i);
+      const auto& frame = terrain_frames_->GetFrame(ee_node_id);
+      Vector3d f = force_nodes.at(pure_stance_force_node_ids_.at(i)).p();
 
       for (auto dim : {X_,Y_}) {
-        Vector3d dn  = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Normal, dim, p.x(), p.y());
-        Vector3d dt1 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent1, dim, p.x(), p.y());
-        Vector3d dt2 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent2, dim, p.x(), p.y());
+        const Vector3d& dn  = frame.dbasis_[HeightMap::Normal][dim];
+        const Vector3d& dt1 = frame.dbasis_[HeightMap::Tangent1][dim];
+        const Vector3d& dt2 = frame.dbasis_[HeightMap::Tangent2][dim];
 
         int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(ee_node_id, kPos, dim));
         int row_reset=row;
@@ -0,0 +1,94 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/constraints/force_limit_constraint.h>
+
+#include <towr/variables/variable_names.h>
+
+namespace towr {
+
+
+ForceLimitConstraint::ForceLimitConstraint (double force_limit, EE ee)
+    :ifopt::ConstraintSet(kSpecifyLater, "forcelimit-" + id::EEForceNodes(ee))
+{
+  fn_max_ = force_limit;
+  ee_     = ee;
+}
+
+void
+ForceLimitConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  ee_force_ = x->GetComponent<NodesVariablesEEForceCone>(id::EEForceNodes(ee_));
+
+  pure_stance_force_node_ids_ = ee_force_->GetIndicesOfNonConstantNodes();
+  SetRows(pure_stance_force_node_ids_.size());
+
+  row_.clear();
+  for (int row=0; row<GetRows(); ++row)
+    row_[pure_stance_force_node_ids_.at(row)] = row;
+}
+
+Eigen::VectorXd
+ForceLimitConstraint::GetValues () const
+{
+  VectorXd g(GetRows());
+
+  const auto& force_nodes = ee_force_->GetNodes();
+  for (int f_node_id : pure_stance_force_node_ids_) {
+    const Eigen::Vector3d& n = ee_force_->GetNormal(f_node_id);
+    g(row_.at(f_node_id)) = force_nodes.at(f_node_id).p().transpose() * n;
+  }
+
+  return g;
+}
+
+ForceLimitConstraint::VecBound
+ForceLimitConstraint::GetBounds () const
+{
+  return VecBound(GetRows(), ifopt::Bounds(0.0, fn_max_));
+}
+
+void
+ForceLimitConstraint::FillJacobianBlock (std::string var_set,
+                                         Jacobian& jac) const
+{
+  if (var_set == ee_force_->GetName()) {
+    for (int idx=0; idx<ee_force_->GetRows(); ++idx) {
+      for (const auto& nvi : ee_force_->GetNodeValuesInfoView(idx)) {
+        if (nvi.deriv_ == kPos) {
+          const Eigen::Vector3d& n = ee_force_->GetNormal(nvi.id_);
+          jac.coeffRef(row_.at(nvi.id_), idx) += n(nvi.dim_)*nvi.weight_;
+        }
+      }
+    }
+  }
+}
+
+} /* namespace towr */
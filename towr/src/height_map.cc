@@ -90,6 +90,50 @@ HeightMap::GetDerivativeOfNormalizedBasisWrt (Direction basis, Dim2D dim,
   return dn_norm_wrt_n.cwiseProduct(dv_wrt_dim);
 }
 
+HeightMap::Frame
+HeightMap::GetFrame (double x, double y) const
+{
+  Frame frame;
+  frame.height_ = GetHeight(x,y);
+  for (auto dim : {X_,Y_})
+    frame.dheight_[dim] = GetDerivativeOfHeightWrt(dim, x, y);
+
+  // second derivative w.r.t. first index, then second
+  double ddh[k2D][k2D];
+  for (auto dim1 : {X_,Y_})
+    for (auto dim2 : {X_,Y_})
+      ddh[dim1][dim2] = GetSecondDerivativeOfHeightWrt(dim1, dim2, x, y);
+
+  double hx = frame.dheight_[X_];
+  double hy = frame.dheight_[Y_];
+  Vector3d v[3];
+  v[Normal]   = Vector3d(-hx, -hy, 1.0);
+  v[Tangent1] = Vector3d(1.0, 0.0, hx);
+  v[Tangent2] = Vector3d(0.0, 1.0, hy);
+
+  for (auto basis : {Normal, Tangent1, Tangent2}) {
+    frame.basis_[basis] = v[basis].normalized();
+
+    for (auto dim : {X_,Y_}) {
+      // same as GetNormal() etc. with the derivative w.r.t. dim
+      double hx_dim = ddh[X_][dim];
+      double hy_dim = ddh[Y_][dim];
+      Vector3d dv_wrt_dim = Vector3d::Zero();
+      switch (basis) {
+        case Normal:   dv_wrt_dim = Vector3d(-hx_dim, -hy_dim, 0.0); break;
+        case Tangent1: dv_wrt_dim = Vector3d(0.0, 0.0, hx_dim);      break;
+        case Tangent2: dv_wrt_dim = Vector3d(0.0, 0.0, hy_dim);      break;
+        default: assert(false); // basis does not exist
+      }
+
+      Vector3d dn_norm_wrt_n = GetDerivativeOfNormalizedVectorWrtNonNormalizedIndex(v[basis], dim);
+      frame.dbasis_[basis][dim] = dn_norm_wrt_n.cwiseProduct(dv_wrt_dim);
+    }
+  }
+
+  return frame;
+}
+
 HeightMap::Vector3d
 HeightMap::GetNormal(double x, double y, const DimDerivs& deriv) const
 {
@@ -35,13 +35,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/constraints/base_motion_constraint.h>
 #include <towr/constraints/dynamic_constraint.h>
 #include <towr/constraints/force_constraint.h>
+#include <towr/constraints/force_limit_constraint.h>
 #include <towr/constraints/range_of_motion_constraint.h>
 #include <towr/constraints/swing_constraint.h>
 #include <towr/constraints/terrain_constraint.h>
 #include <towr/constraints/total_duration_constraint.h>
 #include <towr/constraints/spline_acc_constraint.h>
+#include <towr/constraints/constraint_set_group.h>
+#include <towr/constraints/finite_difference_constraint.h>
+#include <towr/constraints/constant_jacobian_constraint.h>
 
 #include <towr/costs/node_cost.h>
+#include <towr/costs/cost_term_group.h>
 #include <towr/variables/nodes_variables_all.h>
 
 #include <iostream>
@@ -61,7 +66,7 @@ NlpFormulation::NlpFormulation ()
 }
 
 NlpFormulation::VariablePtrVec
-NlpFormulation::GetVariableSets (SplineHolder& spline_holder)
+NlpFormulation::GetVariableSets (SplineHolder& spline_holder) const
 {
   VariablePtrVec vars;
 
@@ -71,7 +76,7 @@ NlpFormulation::GetVariableSets (SplineHolder& spline_holder)
   auto ee_motion = MakeEndeffectorVariables();
   vars.insert(vars.end(), ee_motion.begin(), ee_motion.end());
 
-  auto ee_force = MakeForceVariables();
+  auto ee_force = MakeForceVariables(ee_motion);
   vars.insert(vars.end(), ee_force.begin(), ee_force.end());
 
   auto contact_schedule = MakeContactScheduleVariables();
@@ -156,22 +161,36 @@ NlpFormulation::MakeEndeffectorVariables () const
 }
 
 std::vector<NodesVariablesPhaseBased::Ptr>
-NlpFormulation::MakeForceVariables () const
+NlpFormulation::MakeForceVariables (
+    const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion) const
 {
   std::vector<NodesVariablesPhaseBased::Ptr> vars;
 
   double T = params_.GetTotalTime();
   for (int ee=0; ee<params_.GetEECount(); ee++) {
+    // initialize with mass of robot distributed equally on all legs
+    double m = model_.dynamic_model_->m();
+    double g = model_.dynamic_model_->g();
+
+    if (params_.force_in_friction_cone_basis_) {
+      auto nodes = std::make_shared<NodesVariablesEEForceCone>(
+                                              params_.GetPhaseCount(ee),
+                                              params_.ee_in_contact_at_start_.at(ee),
+                                              id::EEForceNodes(ee),
+                                              params_.force_polynomials_per_stance_phase_,
+                                              terrain_,
+                                              ee_motion.at(ee));
+      nodes->SetNormalForce(m*g/params_.GetEECount());
+      vars.push_back(nodes);
+      continue;
+    }
+
     auto nodes = std::make_shared<NodesVariablesEEForce>(
                                               params_.GetPhaseCount(ee),
                                               params_.ee_in_contact_at_start_.at(ee),
                                               id::EEForceNodes(ee),
                                               params_.force_polynomials_per_stance_phase_);
 
-    // initialize with mass of robot distributed equally on all legs
-    double m = model_.dynamic_model_->m();
-    double g = model_.dynamic_model_->g();
-
     Vector3d f_stance(0.0, 0.0, m*g/params_.GetEECount());
     nodes->SetByLinearInterpolation(f_stance, f_stance, T); // stay constant
     vars.push_back(nodes);
@@ -197,17 +216,74 @@ NlpFormulation::MakeContactScheduleVariables () const
   return vars;
 }
 
+ThreadPool::Ptr
+NlpFormulation::GetThreadPool () const
+{
+  if (params_.n_threads_ > 1 && !thread_pool_)
+    thread_pool_ = std::make_shared<ThreadPool>(params_.n_threads_);
+
+  return thread_pool_;
+}
+
 NlpFormulation::ContraintPtrVec
 NlpFormulation::GetConstraints(const SplineHolder& spline_holder) const
 {
   ContraintPtrVec constraints;
-  for (auto name : params_.constraints_)
-    for (auto c : GetConstraint(name, spline_holder))
+  for (auto name : params_.constraints_) {
+    for (auto c : params_.IsFiniteDifferenceConstraint(name)?
+                    MakeFiniteDifferenceConstraint(name, spline_holder) :
+                    GetConstraint(name, spline_holder)) {
+      if (IsLinear(name))
+        c = std::make_shared<ConstantJacobianConstraint>(c);
       constraints.push_back(c);
+    }
+  }
+
+  if (params_.evaluate_sets_in_parallel_)
+    return {std::make_shared<ConstraintSetGroup>(constraints, GetThreadPool())};
 
   return constraints;
 }
 
+bool
+NlpFormulation::IsLinear (Parameters::ConstraintName name) const
+{
+  switch (name) {
+    case Parameters::Swing:     // between neighboring node values
+    case Parameters::TotalTime: // sum of the phase durations
+    case Parameters::BaseAcc:   // on base splines of fixed durations
+    case Parameters::BaseRom:   // on base splines of fixed durations
+      return true;
+    case Parameters::Force:     // only the normal force of the cone weights
+      return params_.force_in_friction_cone_basis_;
+    default:
+      return false;
+  }
+}
+
+bool
+NlpFormulation::IsJacobianConstant (const ContraintPtrVec& constraints,
+                                    bool equalities)
+{
+  for (const auto& c : constraints) {
+    if (std::dynamic_pointer_cast<ConstantJacobianConstraint>(c))
+      continue;
+
+    auto group = std::dynamic_pointer_cast<ConstraintSetGroup>(c);
+    if (group) {
+      if (!IsJacobianConstant(group->GetConstraints(), equalities))
+        return false;
+      continue;
+    }
+
+    for (const auto& b : c->GetBounds())
+      if ((b.lower_ == b.upper_) == equalities)
+        return false;
+  }
+
+  return true;
+}
+
 NlpFormulation::ContraintPtrVec
 NlpFormulation::GetConstraint (Parameters::ConstraintName name,
                            const SplineHolder& s) const
@@ -225,40 +301,80 @@ NlpFormulation::GetConstraint (Parameters::ConstraintName name,
   }
 }
 
+NlpFormulation::ContraintPtrVec
+NlpFormulation::MakeFiniteDifferenceConstraint (Parameters::ConstraintName name,
+                                                const SplineHolder& s) const
+{
+  ContraintPtrVec constraints = GetConstraint(name, s);
+
+  // the perturbed values are evaluated by one copy per thread, each built
+  // from its own variables.
+  auto pool = GetThreadPool();
+  int n_copies = pool? pool->GetThreadCount() : 1;
+  std::vector<std::vector<FiniteDifferenceConstraint::Copy>> copies(constraints.size());
+  for (int k=0; k<n_copies; ++k) {
+    SplineHolder spline_holder;
+    auto variables = std::make_shared<ifopt::Composite>("variables", false);
+    for (auto v : GetVariableSets(spline_holder))
+      variables->AddComponent(v);
+
+    ContraintPtrVec copy = GetConstraint(name, spline_holder);
+    for (int i=0; i<static_cast<int>(constraints.size()); ++i)
+      copies.at(i).push_back({copy.at(i), variables, spline_holder});
+  }
+
+  ContraintPtrVec fd_constraints;
+  for (int i=0; i<static_cast<int>(constraints.size()); ++i)
+    fd_constraints.push_back(std::make_shared<FiniteDifferenceConstraint>(
+        constraints.at(i), copies.at(i), pool));
+
+  return fd_constraints;
+}
 
 NlpFormulation::ContraintPtrVec
 NlpFormulation::MakeBaseRangeOfMotionConstraint (const SplineHolder& s) const
 {
-  return {std::make_shared<BaseMotionConstraint>(params_.GetTotalTime(),
-                                                 params_.dt_constraint_base_motion_,
-                                                 s)};
+  auto constraint = std::make_shared<BaseMotionConstraint>(params_.GetTotalTime(),
+                                                           params_.dt_constraint_base_motion_,
+                                                           s);
+  constraint->SetThreadPool(GetThreadPool());
+  return {constraint};
+}
+
+std::vector<double>
+NlpFormulation::GetConstraintTimes (double dt) const
+{
+  int n = params_.collocation_points_per_segment_;
+  if (n >= 2)
+    return TimeDiscretizationConstraint::GetCollocationTimes(params_.GetCollocationSegmentEdges(), n);
+
+  return TimeDiscretizationConstraint::GetUniformTimes(params_.GetTotalTime(), dt);
 }
 
 NlpFormulation::ContraintPtrVec
 NlpFormulation::MakeDynamicConstraint(const SplineHolder& s) const
 {
   auto constraint = std::make_shared<DynamicConstraint>(model_.dynamic_model_,
-                                                        params_.GetTotalTime(),
-                                                        params_.dt_constraint_dynamic_,
+                                                        GetConstraintTimes(params_.dt_constraint_dynamic_),
                                                         s);
+  constraint->SetThreadPool(GetThreadPool());
   return {constraint};
 }
 
 NlpFormulation::ContraintPtrVec
 NlpFormulation::MakeRangeOfMotionBoxConstraint (const SplineHolder& s) const
 {
-  ContraintPtrVec c;
-
-  for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto rom = std::make_shared<RangeOfMotionConstraint>(model_.kinematic_model_,
-                                                         params_.GetTotalTime(),
-                                                         params_.dt_constraint_range_of_motion_,
-                                                         ee,
-                                                         s);
-    c.push_back(rom);
-  }
-
-  return c;
+  // one set for all endeffectors, so the base is only evaluated once
+  std::vector<RangeOfMotionConstraint::EE> ees;
+  for (int ee=0; ee<params_.GetEECount(); ee++)
+    ees.push_back(ee);
+
+  auto rom = std::make_shared<RangeOfMotionConstraint>(model_.kinematic_model_,
+                                                       GetConstraintTimes(params_.dt_constraint_range_of_motion_),
+                                                       ees,
+                                                       s);
+  rom->SetThreadPool(GetThreadPool());
+  return {rom};
 }
 
 NlpFormulation::ContraintPtrVec
@@ -294,6 +410,12 @@ NlpFormulation::MakeForceConstraint () const
   ContraintPtrVec constraints;
 
   for (int ee=0; ee<params_.GetEECount(); ee++) {
+    if (params_.force_in_friction_cone_basis_) {
+      constraints.push_back(std::make_shared<ForceLimitConstraint>(
+          params_.force_limit_in_normal_direction_, ee));
+      continue;
+    }
+
     auto c = std::make_shared<ForceConstraint>(terrain_,
                                                params_.force_limit_in_normal_direction_,
                                                ee);
@@ -338,6 +460,9 @@ NlpFormulation::GetCosts() const
     for (auto c : GetCost(pair.first, pair.second))
       costs.push_back(c);
 
+  if (params_.evaluate_sets_in_parallel_ && !costs.empty())
+    return {std::make_shared<CostTermGroup>(costs, GetThreadPool())};
+
   return costs;
 }
 
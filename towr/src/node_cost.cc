@@ -53,8 +53,8 @@ NodeCost::InitVariableDependedQuantities (const VariablesPtr& x)
 double
 NodeCost::GetCost () const
 {
-  double cost;
-  for (auto n : nodes_->GetNodes()) {
+  double cost = 0.0;
+  for (const auto& n : nodes_->GetNodes()) {
     double val = n.at(deriv_)(dim_);
     cost += weight_*std::pow(val,2);
   }
@@ -66,11 +66,12 @@ void
 NodeCost::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
   if (var_set == node_id_) {
+    const auto& nodes = nodes_->GetNodes();
     for (int i=0; i<nodes_->GetRows(); ++i)
-      for (auto nvi : nodes_->GetNodeValuesInfo(i))
+      for (const auto& nvi : nodes_->GetNodeValuesInfoView(i))
         if (nvi.deriv_==deriv_ && nvi.dim_==dim_) {
-          double val = nodes_->GetNodes().at(nvi.id_).at(deriv_)(dim_);
-          jac.coeffRef(0, i) += weight_*2.0*val;
+          double val = nodes.at(nvi.id_).at(deriv_)(dim_);
+          jac.coeffRef(0, i) += weight_*2.0*val*nvi.weight_;
         }
   }
 }
@@ -31,6 +31,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes_variables.h>
 
+#include <algorithm>
+
 namespace towr {
 
 NodeSpline::NodeSpline(NodeSubjectPtr const node_variables,
@@ -38,19 +40,61 @@ NodeSpline::NodeSpline(NodeSubjectPtr const node_variables,
     :   Spline(polynomial_durations, node_variables->GetDim()),
         NodesObserver(node_variables)
 {
-  UpdateNodes();
+  for (int i=0; i<static_cast<int>(cubic_polys_.size()); ++i)
+    SetPolynomialNodes(i);
+  UpdatePolynomialCoeff();
+
   jac_wrt_nodes_structure_ = Jacobian(node_variables->GetDim(), node_variables->GetRows());
+  BuildJacobianStencils();
+}
+
+void
+NodeSpline::BuildJacobianStencils ()
+{
+  int n_polys = cubic_polys_.size();
+  jac_stencils_.assign(n_polys, {});
+
+  for (int idx=0; idx<node_values_->GetRows(); ++idx) {
+    for (const auto& nvi : node_values_->GetNodeValuesInfoView(idx)) {
+      for (auto side : {NodesVariables::Side::Start, NodesVariables::Side::End}) {
+        // node is the start of polynomial "id" and the end of polynomial "id-1"
+        int poly_id = nvi.id_ - side;
+        if (0 <= poly_id && poly_id < n_polys) {
+          assert(node_values_->GetNodeId(poly_id, side) == nvi.id_);
+          jac_stencils_.at(poly_id).push_back({idx, side, nvi.deriv_, nvi.dim_, nvi.weight_});
+        }
+      }
+    }
+  }
 }
 
 void
 NodeSpline::UpdateNodes ()
 {
-  for (int i=0; i<cubic_polys_.size(); ++i) {
-    auto nodes = node_values_->GetBoundaryNodes(i);
-    cubic_polys_.at(i).SetNodes(nodes.front(), nodes.back());
+  // a node is the end of one and the start of the next polynomial
+  std::vector<int> poly_ids;
+  for (int node_id : node_values_->GetChangedNodeIds()) {
+    for (auto side : {NodesVariables::Side::Start, NodesVariables::Side::End}) {
+      int poly_id = node_id - side;
+      if (0 <= poly_id && poly_id < static_cast<int>(cubic_polys_.size()))
+        poly_ids.push_back(poly_id);
+    }
   }
 
-  UpdatePolynomialCoeff();
+  std::sort(poly_ids.begin(), poly_ids.end());
+  poly_ids.erase(std::unique(poly_ids.begin(), poly_ids.end()), poly_ids.end());
+
+  for (int i : poly_ids) {
+    SetPolynomialNodes(i);
+    UpdatePolynomialCoeff(i);
+  }
+}
+
+void
+NodeSpline::SetPolynomialNodes (int poly_id)
+{
+  cubic_polys_.at(poly_id).SetNodes(node_values_->GetBoundaryNode(poly_id, NodesVariables::Start),
+                                    node_values_->GetBoundaryNode(poly_id, NodesVariables::End));
 }
 
 int
@@ -62,8 +106,13 @@ NodeSpline::GetNodeVariablesCount() const
 NodeSpline::Jacobian
 NodeSpline::GetJacobianWrtNodes (double t_global, Dx dxdt) const
 {
+  UpdateIfOutdated();
+  auto it = jac_precomputed_.find({dxdt, t_global});
+  if (it != jac_precomputed_.end())
+    return it->second;
+
   int id; double t_local;
-  std::tie(id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(id, t_local) = GetLocalTime(t_global);
 
   return GetJacobianWrtNodes(id, t_local, dxdt);
 }
@@ -71,6 +120,7 @@ NodeSpline::GetJacobianWrtNodes (double t_global, Dx dxdt) const
 NodeSpline::Jacobian
 NodeSpline::GetJacobianWrtNodes (int id, double t_local, Dx dxdt) const
 {
+  UpdateIfOutdated();
   Jacobian jac = jac_wrt_nodes_structure_;
   FillJacobianWrtNodes(id, t_local, dxdt, jac, false);
 
@@ -81,33 +131,139 @@ NodeSpline::GetJacobianWrtNodes (int id, double t_local, Dx dxdt) const
   return jac;
 }
 
+NodeSpline::Jacobian
+NodeSpline::GetJacobiansWrtNodes (const VecTimes& t_global, Dx dxdt) const
+{
+  UpdateIfOutdated();
+  int n = t_global.size();
+  int n_dim = jac_wrt_nodes_structure_.rows();
+
+  std::vector<int> ids(n);
+  std::vector<double> t_local(n);
+  for (int k=0; k<n; ++k)
+    std::tie(ids[k], t_local[k]) = GetLocalTime(t_global[k]);
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(n*(jac_wrt_nodes_structure_.nonZeros() + 4*n_dim));
+
+  // elements that are only part of the sparsity structure
+  for (int k=0; k<n; ++k)
+    for (int dim=0; dim<jac_wrt_nodes_structure_.outerSize(); ++dim)
+      for (Jacobian::InnerIterator e(jac_wrt_nodes_structure_, dim); e; ++e)
+        triplets.push_back(Eigen::Triplet<double>(k*n_dim+dim, e.col(), 0.0));
+
+  // every run of times in the same polynomial shares its stencil
+  int k = 0;
+  while (k < n) {
+    int n_run = 1;
+    while (k+n_run < n && ids[k+n_run] == ids[k])
+      n_run++;
+
+    const auto& poly = cubic_polys_.at(ids[k]);
+    for (const auto& e : jac_stencils_.at(ids[k])) {
+      for (int i=k; i<k+n_run; ++i) {
+        double val = e.side_ == NodesVariables::Side::Start
+            ? poly.GetDerivativeWrtStartNode(dxdt, e.deriv_, t_local[i])
+            : poly.GetDerivativeWrtEndNode(dxdt, e.deriv_, t_local[i]);
+        triplets.push_back(Eigen::Triplet<double>(i*n_dim+e.dim_, e.opt_idx_, e.weight_*val));
+      }
+    }
+    k += n_run;
+  }
+
+  Jacobian jac(n*n_dim, jac_wrt_nodes_structure_.cols());
+  jac.setFromTriplets(triplets.begin(), triplets.end());
+  return jac;
+}
+
+template<typename F>
+void
+NodeSpline::ForEachJacobianElement (double t_global, Dx dxdt, F f) const
+{
+  UpdateIfOutdated();
+  auto it = jac_precomputed_.find({dxdt, t_global});
+  if (it != jac_precomputed_.end()) {
+    const Jacobian& jac = it->second;
+    for (int dim=0; dim<jac.outerSize(); ++dim)
+      for (Jacobian::InnerIterator e(jac, dim); e; ++e)
+        f(dim, e.col(), e.value());
+    return;
+  }
+
+  // elements that are only part of the sparsity structure
+  for (int dim=0; dim<jac_wrt_nodes_structure_.outerSize(); ++dim)
+    for (Jacobian::InnerIterator e(jac_wrt_nodes_structure_, dim); e; ++e)
+      f(dim, e.col(), 0.0);
+
+  int poly_id; double t_local;
+  std::tie(poly_id, t_local) = GetLocalTime(t_global);
+  const auto& poly = cubic_polys_.at(poly_id);
+
+  for (const auto& e : jac_stencils_.at(poly_id)) {
+    double val = e.side_ == NodesVariables::Side::Start
+        ? poly.GetDerivativeWrtStartNode(dxdt, e.deriv_, t_local)
+        : poly.GetDerivativeWrtEndNode(dxdt, e.deriv_, t_local);
+    f(e.dim_, e.opt_idx_, e.weight_*val);
+  }
+}
+
+void
+NodeSpline::FillJacobianWrtNodes (double t_global, Dx dxdt, int row,
+                                  Jacobian& jac) const
+{
+  ForEachJacobianElement(t_global, dxdt, [&](int dim, int col, double val) {
+    jac.coeffRef(row+dim, col) += val;
+  });
+}
+
+void
+NodeSpline::FillJacobianWrtNodes (double t_global, Dx dxdt,
+                                  const Eigen::Ref<const Eigen::MatrixXd>& M,
+                                  int row, Jacobian& jac) const
+{
+  ForEachJacobianElement(t_global, dxdt, [&](int dim, int col, double val) {
+    for (int i=0; i<M.rows(); ++i)
+      jac.coeffRef(row+i, col) += M(i,dim)*val;
+  });
+}
+
+void
+NodeSpline::PrecomputeJacobiansWrtNodes (const VecTimes& t_global, Dx dxdt)
+{
+  UpdateIfOutdated();
+  for (double t : t_global)
+    if (jac_precomputed_.find({dxdt, t}) == jac_precomputed_.end())
+      jac_precomputed_[{dxdt, t}] = GetJacobianWrtNodes(t, dxdt);
+}
+
+void
+NodeSpline::ClearPrecomputedJacobians ()
+{
+  jac_precomputed_.clear();
+}
+
 void
 NodeSpline::FillJacobianWrtNodes (int poly_id, double t_local, Dx dxdt,
                                   Jacobian& jac, bool fill_with_zeros) const
 {
-  for (int idx=0; idx<jac.cols(); ++idx) {
-    for (auto nvi : node_values_->GetNodeValuesInfo(idx)) {
-      for (auto side : {NodesVariables::Side::Start, NodesVariables::Side::End}) { // every jacobian is affected by two nodes
-        int node = node_values_->GetNodeId(poly_id, side);
-
-        if (node == nvi.id_) {
-          double val = 0.0;
-
-          if (side == NodesVariables::Side::Start)
-            val = cubic_polys_.at(poly_id).GetDerivativeWrtStartNode(dxdt, nvi.deriv_, t_local);
-          else if (side == NodesVariables::Side::End)
-            val = cubic_polys_.at(poly_id).GetDerivativeWrtEndNode(dxdt, nvi.deriv_, t_local);
-          else
-            assert(false); // this shouldn't happen
-
-          // if only want structure
-          if (fill_with_zeros)
-            val = 0.0;
-
-          jac.coeffRef(nvi.dim_, idx) += val;
-        }
-      }
-    }
+  const auto& poly = cubic_polys_.at(poly_id);
+
+  // only the node values of this polynomial's two nodes have an effect
+  for (const auto& e : jac_stencils_.at(poly_id)) {
+    double val = 0.0;
+
+    if (e.side_ == NodesVariables::Side::Start)
+      val = poly.GetDerivativeWrtStartNode(dxdt, e.deriv_, t_local);
+    else if (e.side_ == NodesVariables::Side::End)
+      val = poly.GetDerivativeWrtEndNode(dxdt, e.deriv_, t_local);
+    else
+      assert(false); // this shouldn't happen
+
+    // if only want structure
+    if (fill_with_zeros)
+      val = 0.0;
+
+    jac.coeffRef(e.dim_, e.opt_idx_) += e.weight_*val;
   }
 }
 
@@ -29,34 +29,97 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes_variables.h>
 
+#include <cassert>
+
 namespace towr {
 
+const int NodesVariables::NodeValueNotOptimized;
 
 NodesVariables::NodesVariables (const std::string& name)
     : VariableSet(kSpecifyLater, name)
 {
 }
 
+void
+NodesVariables::InitNodes (int n_nodes, int n_dim)
+{
+  n_dim_ = n_dim;
+  int n_values_per_node = Node::n_derivatives*n_dim;
+  values_ = VectorXd::Zero(n_nodes*n_values_per_node);
+
+  // constructed in place, since copies of a node own their values
+  nodes_.clear();
+  nodes_.reserve(n_nodes);
+  for (int id=0; id<n_nodes; ++id)
+    nodes_.emplace_back(values_.data() + id*n_values_per_node, n_dim);
+}
+
 int
-NodesVariables::GetOptIndex(const NodeValueInfo& nvi_des) const
+NodesVariables::GetValueIndex (const NodeValueInfo& nvi) const
+{
+  return (nvi.id_*Node::n_derivatives + nvi.deriv_)*n_dim_ + nvi.dim_;
+}
+
+void
+NodesVariables::BuildIndexTables ()
 {
-  // could also cache this as map for more efficiency, but adding complexity
-  for (int idx=0; idx<GetRows(); ++idx)
-    for ( NodeValueInfo nvi : GetNodeValuesInfo(idx))
-      if ( nvi == nvi_des )
-        return idx;
+  opt_index_.assign(values_.size(), NodeValueNotOptimized);
+  node_values_begin_ = {0};
+  node_values_info_.clear();
+  value_index_.clear();
 
-  return NodeValueNotOptimized; // index representing these quantities doesn't exist
+  values_are_sums_ = false;
+  for (int idx=0; idx<GetRows(); ++idx) {
+    for (auto nvi : GetNodeValuesInfo(idx)) {
+      values_are_sums_ = values_are_sums_ || nvi.weight_ != 1.0
+                         || opt_index_.at(GetValueIndex(nvi)) != NodeValueNotOptimized;
+      opt_index_.at(GetValueIndex(nvi)) = idx;
+      node_values_info_.push_back(nvi);
+      value_index_.push_back(GetValueIndex(nvi));
+    }
+    node_values_begin_.push_back(node_values_info_.size());
+  }
+
+  variables_ = values_are_sums_? VectorXd::Zero(GetRows()) : VectorXd();
+
+  // every optimization variable is exactly the node value stored at its index
+  values_are_variables_ = GetRows() == values_.size() && !values_are_sums_;
+  for (int idx=0; idx<GetRows() && values_are_variables_; ++idx)
+    values_are_variables_ = node_values_begin_.at(idx+1)-node_values_begin_.at(idx) == 1
+                            && value_index_.at(node_values_begin_.at(idx)) == idx;
+}
+
+int
+NodesVariables::GetOptIndex(const NodeValueInfo& nvi) const
+{
+  // e.g. neighbors of the first or last node
+  if (nvi.id_ < 0 || nvi.id_ >= static_cast<int>(nodes_.size()))
+    return NodeValueNotOptimized;
+
+  return opt_index_.at(GetValueIndex(nvi));
+}
+
+NodesVariables::NodeValueInfoView
+NodesVariables::GetNodeValuesInfoView (int idx) const
+{
+  const NodeValueInfo* values = node_values_info_.data();
+  return {values + node_values_begin_.at(idx), values + node_values_begin_.at(idx+1)};
 }
 
 Eigen::VectorXd
 NodesVariables::GetValues () const
 {
-  VectorXd x(GetRows());
+  if (values_are_variables_)
+    return values_;
+
+  if (values_are_sums_)
+    return variables_;
 
+  // gather one of the node values set by each variable, the last one as
+  // these can differ before the variables are first set
+  VectorXd x(GetRows());
   for (int idx=0; idx<x.rows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      x(idx) = nodes_.at(nvi.id_).at(nvi.deriv_)(nvi.dim_);
+    x(idx) = values_(value_index_.at(node_values_begin_.at(idx+1)-1));
 
   return x;
 }
@@ -64,13 +127,72 @@ NodesVariables::GetValues () const
 void
 NodesVariables::SetVariables (const VectorXd& x)
 {
-  for (int idx=0; idx<x.rows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      nodes_.at(nvi.id_).at(nvi.deriv_)(nvi.dim_) = x(idx);
+  node_changed_.resize(nodes_.size(), false);
+  changed_node_ids_.clear();
+
+  if (values_are_variables_) {
+    int n = Node::n_derivatives*n_dim_;
+    for (int id=0; id<static_cast<int>(nodes_.size()); ++id)
+      if (x.segment(id*n, n) != values_.segment(id*n, n))
+        changed_node_ids_.push_back(id);
+    values_ = x;
+  }
+  else if (values_are_sums_) {
+    // each node value is the weighted sum of the variables setting it
+    VectorXd values = values_;
+    for (int i : value_index_)
+      values(i) = 0.0;
+    for (int idx=0; idx<x.rows(); ++idx)
+      for (int i=node_values_begin_.at(idx); i<node_values_begin_.at(idx+1); ++i)
+        values(value_index_.at(i)) += node_values_info_.at(i).weight_*x(idx);
+
+    int n = Node::n_derivatives*n_dim_;
+    for (int id=0; id<static_cast<int>(nodes_.size()); ++id)
+      if (values.segment(id*n, n) != values_.segment(id*n, n))
+        changed_node_ids_.push_back(id);
+    values_ = values;
+    variables_ = x;
+  }
+  else {
+    // scatter each variable to all node values it sets
+    for (int idx=0; idx<x.rows(); ++idx) {
+      for (int i=node_values_begin_.at(idx); i<node_values_begin_.at(idx+1); ++i) {
+        double& val = values_(value_index_.at(i));
+        if (val != x(idx)) {
+          val = x(idx);
+          int id = node_values_info_.at(i).id_;
+          if (!node_changed_.at(id)) {
+            node_changed_.at(id) = true;
+            changed_node_ids_.push_back(id);
+          }
+        }
+      }
+    }
+
+    for (int id : changed_node_ids_)
+      node_changed_.at(id) = false;
+  }
+
+  // e.g. during line-search or finite differences often nothing changes
+  if (changed_node_ids_.empty())
+    return;
 
+  version_++;
   UpdateObservers();
 }
 
+const std::vector<int>&
+NodesVariables::GetChangedNodeIds () const
+{
+  return changed_node_ids_;
+}
+
+int
+NodesVariables::GetVersion () const
+{
+  return version_;
+}
+
 void
 NodesVariables::UpdateObservers() const
 {
@@ -99,6 +221,12 @@ NodesVariables::GetBoundaryNodes(int poly_id) const
   return nodes;
 }
 
+const Node&
+NodesVariables::GetBoundaryNode (int poly_id, Side side) const
+{
+  return nodes_.at(GetNodeId(poly_id, side));
+}
+
 int
 NodesVariables::GetDim() const
 {
@@ -117,7 +245,7 @@ NodesVariables::GetBounds () const
   return bounds_;
 }
 
-const std::vector<Node>
+const std::vector<Node>&
 NodesVariables::GetNodes() const
 {
   return nodes_;
@@ -130,12 +258,13 @@ NodesVariables::SetByLinearInterpolation(const VectorXd& initial_val,
 {
   // only set those that are part of optimization variables,
   // do not overwrite phase-based parameterization
+  assert(!values_are_sums_); // variables can't be recovered from node values
   VectorXd dp = final_val-initial_val;
   VectorXd average_velocity = dp / t_total;
   int num_nodes = nodes_.size();
 
   for (int idx=0; idx<GetRows(); ++idx) {
-    for (auto nvi : GetNodeValuesInfo(idx)) {
+    for (const auto& nvi : GetNodeValuesInfoView(idx)) {
 
       if (nvi.deriv_ == kPos) {
         VectorXd pos = initial_val + nvi.id_/static_cast<double>(num_nodes-1)*dp;
@@ -161,10 +290,9 @@ NodesVariables::AddBounds(int node_id, Dx deriv,
 void
 NodesVariables::AddBound (const NodeValueInfo& nvi_des, double val)
 {
-  for (int idx=0; idx<GetRows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      if (nvi == nvi_des)
-        bounds_.at(idx) = ifopt::Bounds(val, val);
+  int idx = GetOptIndex(nvi_des);
+  if (idx != NodeValueNotOptimized)
+    bounds_.at(idx) = ifopt::Bounds(val, val);
 }
 
 void
@@ -180,11 +308,13 @@ NodesVariables::AddFinalBound (Dx deriv, const std::vector<int>& dimensions,
   AddBounds(nodes_.size()-1, deriv, dimensions, val);
 }
 
-NodesVariables::NodeValueInfo::NodeValueInfo(int node_id, Dx deriv, int node_dim)
+NodesVariables::NodeValueInfo::NodeValueInfo(int node_id, Dx deriv, int node_dim,
+                                             double weight)
 {
-  id_    = node_id;
-  deriv_ = deriv;
-  dim_   = node_dim;
+  id_     = node_id;
+  deriv_  = deriv;
+  dim_    = node_dim;
+  weight_ = weight;
 }
 
 int
@@ -36,10 +36,10 @@ NodesVariablesAll::NodesVariablesAll (int n_nodes, int n_dim, std::string variab
 {
   int n_opt_variables = n_nodes*Node::n_derivatives*n_dim;
 
-  n_dim_ = n_dim;
-  nodes_  = std::vector<Node>(n_nodes, Node(n_dim));
+  InitNodes(n_nodes, n_dim);
   bounds_ = VecBound(n_opt_variables, ifopt::NoBound);
   SetRows(n_opt_variables);
+  BuildIndexTables();
 }
 
 std::vector<NodesVariablesAll::NodeValueInfo>
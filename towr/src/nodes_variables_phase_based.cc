@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/variables/cartesian_dimensions.h>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace towr {
 
@@ -65,9 +66,8 @@ NodesVariablesPhaseBased::NodesVariablesPhaseBased (int phase_count,
 {
   polynomial_info_ = BuildPolyInfos(phase_count, first_phase_constant, n_polys_in_changing_phase);
 
-  n_dim_ = k3D;
   int n_nodes = polynomial_info_.size()+1;
-  nodes_  = std::vector<Node>(n_nodes, Node(n_dim_));
+  InitNodes(n_nodes, k3D);
 }
 
 NodesVariablesPhaseBased::VecDurations
@@ -192,6 +192,7 @@ NodesVariablesPhaseBased::SetNumberOfVariables(int n_variables)
 {
   bounds_ = VecBound(n_variables, ifopt::NoBound);
   SetRows(n_variables);
+  BuildIndexTables();
 }
 
 NodesVariablesEEMotion::NodesVariablesEEMotion(int phase_count,
@@ -297,4 +298,95 @@ NodesVariablesEEForce::GetPhaseBasedEEParameterization ()
   return index_map;
 }
 
+NodesVariablesEEForceCone::NodesVariablesEEForceCone(int phase_count,
+                                                     bool is_in_contact_at_start,
+                                                     const std::string& name,
+                                                     int n_polys_in_changing_phase,
+                                                     const HeightMap::Ptr& terrain,
+                                                     const NodesVariablesPhaseBased::Ptr& ee_motion)
+    :NodesVariablesEEForce(phase_count,
+                           is_in_contact_at_start,
+                           name,
+                           n_polys_in_changing_phase)
+{
+  if (!terrain->IsNormalConstant())
+    throw std::invalid_argument("NodesVariablesEEForceCone: the friction "
+                                "pyramids are fixed, so the terrain normal "
+                                "must be constant");
+
+  index_to_node_value_info_ = GetFrictionConeParameterization(terrain, *ee_motion);
+  SetNumberOfVariables(index_to_node_value_info_.size());
+
+  // only the edge weights, the derivatives are plain xyz-values
+  for (int idx=0; idx<GetRows(); ++idx)
+    if (index_to_node_value_info_.at(idx).front().deriv_ == kPos)
+      bounds_.at(idx) = ifopt::BoundGreaterZero;
+}
+
+NodesVariablesEEForceCone::OptIndexMap
+NodesVariablesEEForceCone::GetFrictionConeParameterization (
+    const HeightMap::Ptr& terrain, const NodesVariablesPhaseBased& ee_motion)
+{
+  OptIndexMap index_map;
+  double mu = terrain->GetFrictionCoeff();
+
+  // the footholds as set by the variables, since the initial node values
+  // during a stance phase can still differ.
+  VectorXd ee_pos = ee_motion.GetValues();
+
+  int idx = 0; // index in variables set
+  for (int id : GetIndicesOfNonConstantNodes()) {
+    // foot position doesn't change during stance phase
+    int ee_node_id = ee_motion.GetNodeIDAtStartOfPhase(GetPhase(id));
+    double x = ee_pos(ee_motion.GetOptIndex(NodeValueInfo(ee_node_id, kPos, X)));
+    double y = ee_pos(ee_motion.GetOptIndex(NodeValueInfo(ee_node_id, kPos, Y)));
+    HeightMap::Frame frame = terrain->GetFrame(x, y);
+
+    const Eigen::Vector3d& n  = frame.basis_[HeightMap::Normal];
+    const Eigen::Vector3d& t1 = frame.basis_[HeightMap::Tangent1];
+    const Eigen::Vector3d& t2 = frame.basis_[HeightMap::Tangent2];
+    normals_[id] = n;
+
+    // the tangents are not orthogonal on sloped terrain, so span the pyramid
+    // with their dual basis (d1*t1 = d2*t2 = 1, d1*t2 = d2*t1 = 0). Then the
+    // edges lie exactly on the planes f*t = +-mu*f*n of the ForceConstraint.
+    double c = t1.dot(t2);
+    Eigen::Vector3d d1 = (t1 - c*t2)/(1.0 - c*c);
+    Eigen::Vector3d d2 = (t2 - c*t1)/(1.0 - c*c);
+
+    for (double s1 : {-1.0, 1.0}) {
+      for (double s2 : {-1.0, 1.0}) {
+        Eigen::Vector3d edge = n + mu*(s1*d1 + s2*d2);
+        for (int dim=0; dim<GetDim(); ++dim)
+          index_map[idx].push_back(NodeValueInfo(id, kPos, dim, edge(dim)));
+        idx++;
+      }
+    }
+
+    // a combination of the edges would leave the derivative underdetermined
+    for (int dim=0; dim<GetDim(); ++dim)
+      index_map[idx++].push_back(NodeValueInfo(id, kVel, dim));
+  }
+
+  return index_map;
+}
+
+const Eigen::Vector3d&
+NodesVariablesEEForceCone::GetNormal (int node_id) const
+{
+  return normals_.at(node_id);
+}
+
+void
+NodesVariablesEEForceCone::SetNormalForce (double fn)
+{
+  // every edge has a normal component of 1, and the tangential ones cancel
+  VectorXd x = VectorXd::Zero(GetRows());
+  for (int idx=0; idx<GetRows(); ++idx)
+    if (index_to_node_value_info_.at(idx).front().deriv_ == kPos)
+      x(idx) = fn/n_edges;
+
+  SetVariables(x);
+}
+
 } /* namespace towr */
@@ -0,0 +1,441 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/null_space_reduction.h>
+
+#include <cmath>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include <Eigen/SparseQR>
+#include <Eigen/OrderingMethods>
+
+#include <ifopt/cost_term.h>
+
+#include <towr/constraints/constant_jacobian_constraint.h>
+
+namespace towr {
+
+using Jacobian = NullSpaceReduction::Jacobian;
+using VectorXd = Eigen::VectorXd;
+using VecBound = ifopt::Component::VecBound;
+
+
+/**
+ * @brief The variables y, which set the original ones to x0 + Z*y.
+ */
+class ReducedVariables : public ifopt::VariableSet {
+public:
+  ReducedVariables (const ifopt::Composite::Ptr& x, const VectorXd& x0,
+                    const Jacobian& Z, const VectorXd& y, const VecBound& bounds)
+      :VariableSet(y.rows(), "reduced-variables"), x_(x), x0_(x0), Z_(Z),
+       y_(y), bounds_(bounds) {}
+
+  VectorXd GetValues() const override { return y_; };
+  VecBound GetBounds() const override { return bounds_; };
+  void SetVariables(const VectorXd& y) override
+  {
+    y_ = y;
+    x_->SetVariables(x0_ + Z_*y);
+  }
+
+private:
+  ifopt::Composite::Ptr x_;
+  VectorXd x0_;
+  Jacobian Z_;
+  VectorXd y_;
+  VecBound bounds_;
+};
+
+
+/**
+ * @brief A constraint on x, whose Jacobian w.r.t. y is J*Z.
+ *
+ * For linear sets (see ConstantJacobianConstraint) J*Z is computed only once.
+ */
+class ReducedConstraint : public ifopt::ConstraintSet {
+public:
+  ReducedConstraint (const ifopt::ConstraintSet::Ptr& c, const Jacobian& Z)
+      :ConstraintSet(c->GetRows(), c->GetName()), c_(c), Z_(Z)
+  {
+    if (std::dynamic_pointer_cast<ConstantJacobianConstraint>(c)) {
+      jac_ = c_->GetJacobian()*Z_;
+      jac_.makeCompressed();
+      is_linear_ = true;
+    }
+  }
+
+  VectorXd GetValues() const override { return c_->GetValues(); };
+  VecBound GetBounds() const override { return c_->GetBounds(); };
+  void FillJacobianBlock (std::string, Jacobian& jac) const override
+  {
+    if (is_linear_)
+      jac = jac_;
+    else
+      jac = c_->GetJacobian()*Z_;
+  }
+
+private:
+  ifopt::ConstraintSet::Ptr c_;
+  Jacobian Z_;
+  Jacobian jac_; ///< the constant J*Z of linear sets.
+  bool is_linear_ = false;
+};
+
+
+/**
+ * @brief A cost on x, whose gradient w.r.t. y is J*Z.
+ */
+class ReducedCost : public ifopt::CostTerm {
+public:
+  ReducedCost (const ifopt::ConstraintSet::Ptr& c, const Jacobian& Z)
+      :CostTerm(c->GetName()), c_(c), Z_(Z) {}
+
+  void FillJacobianBlock (std::string, Jacobian& jac) const override
+  {
+    jac = c_->GetJacobian()*Z_;
+  }
+
+private:
+  ifopt::ConstraintSet::Ptr c_;
+  Jacobian Z_;
+
+  double GetCost() const override { return c_->GetValues()(0); };
+};
+
+
+/**
+ * @brief The bounds of the eliminated variables that aren't fixed.
+ */
+class ReducedVariableBounds : public ifopt::ConstraintSet {
+public:
+  ReducedVariableBounds (const ifopt::Composite::Ptr& x,
+                         const std::vector<int>& ids, const Jacobian& Z)
+      :ConstraintSet(ids.size(), "reduced-variable-bounds"), x_(x), ids_(ids)
+  {
+    jac_.resize(ids.size(), Z.cols());
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int row=0; row<jac_.rows(); ++row)
+      for (Jacobian::InnerIterator it(Z, ids.at(row)); it; ++it)
+        triplets.push_back(Eigen::Triplet<double>(row, it.col(), it.value()));
+    jac_.setFromTriplets(triplets.begin(), triplets.end());
+
+    VecBound b = x->GetBounds();
+    for (int id : ids)
+      bounds_.push_back(b.at(id));
+  }
+
+  VectorXd GetValues() const override
+  {
+    VectorXd x = x_->GetValues();
+    VectorXd g(ids_.size());
+    for (int row=0; row<g.rows(); ++row)
+      g(row) = x(ids_.at(row));
+    return g;
+  };
+
+  VecBound GetBounds() const override { return bounds_; };
+  void FillJacobianBlock (std::string, Jacobian& jac) const override
+  {
+    jac = jac_;
+  }
+
+private:
+  ifopt::Composite::Ptr x_;
+  std::vector<int> ids_;
+  Jacobian jac_;
+  VecBound bounds_;
+};
+
+
+NullSpaceReduction::NullSpaceReduction (const VariablePtrVec& variables,
+                                        const ContraintPtrVec& constraints,
+                                        const ContraintPtrVec& costs)
+{
+  x_ = std::make_shared<ifopt::Composite>("variables", false);
+  for (const auto& v : variables)
+    x_->AddComponent(v);
+
+  // nodes sharing a variable might still hold different initial values.
+  VectorXd x_init = x_->GetValues();
+  x_->SetVariables(x_init);
+
+  for (const auto& c : constraints)
+    c->LinkWithVariables(x_);
+  for (const auto& c : costs)
+    c->LinkWithVariables(x_);
+
+  int n = x_->GetRows();
+  VecBound bounds = x_->GetBounds();
+
+  auto is_bounded = [&](int i) {
+    return bounds.at(i).lower_ > -ifopt::inf || bounds.at(i).upper_ < ifopt::inf;
+  };
+
+  // every eliminated variable is an affine expression in the free ones.
+  using Row = std::map<int,double>;
+  std::vector<Row> expr(n);
+  std::vector<double> expr_const(n, 0.0);
+  std::vector<bool> is_basic(n, false);
+  std::vector<std::set<int>> appears_in(n); // the expressions of a free variable.
+
+  // substitutes the eliminated variables of a row a*x = rhs.
+  auto substitute = [&](const Row& row, double& rhs) {
+    Row r;
+    for (const auto& a : row) {
+      if (is_basic.at(a.first)) {
+        rhs -= a.second*expr_const.at(a.first);
+        for (const auto& e : expr.at(a.first))
+          r[e.first] += a.second*e.second;
+      }
+      else
+        r[a.first] += a.second;
+    }
+    return r;
+  };
+
+  // eliminates variable p by the row a*x = rhs of only free variables.
+  auto eliminate = [&](int p, const Row& row, double rhs) {
+    double a_p = row.at(p);
+    Row e;
+    for (const auto& a : row)
+      if (a.first != p)
+        e[a.first] = -a.second/a_p;
+    double e_const = rhs/a_p;
+
+    for (int b : appears_in.at(p)) {
+      Row& eb = expr.at(b);
+      double c = eb.at(p);
+      eb.erase(p);
+      expr_const.at(b) += c*e_const;
+      for (const auto& a : e) {
+        double& v = eb[a.first];
+        v += c*a.second;
+        if (std::abs(v) < 1e-12) {
+          eb.erase(a.first);
+          appears_in.at(a.first).erase(b);
+        }
+        else
+          appears_in.at(a.first).insert(b);
+      }
+    }
+    appears_in.at(p).clear();
+
+    for (const auto& a : e)
+      appears_in.at(a.first).insert(p);
+    expr.at(p) = e;
+    expr_const.at(p) = e_const;
+    is_basic.at(p) = true;
+  };
+
+  // the variables fixed by their bounds
+  for (int i=0; i<n; ++i) {
+    if (bounds.at(i).lower_ == bounds.at(i).upper_) {
+      eliminate(i, {{i, 1.0}}, bounds.at(i).lower_);
+      fixed_ids_.push_back(i);
+    }
+  }
+
+  // the linear constraint sets with only equalities
+  std::vector<bool> is_eliminated;
+  for (const auto& c : constraints) {
+    bool eliminate_set = std::dynamic_pointer_cast<ConstantJacobianConstraint>(c) != nullptr;
+    for (const auto& b : c->GetBounds())
+      eliminate_set = eliminate_set && b.lower_ == b.upper_;
+    is_eliminated.push_back(eliminate_set);
+
+    if (!eliminate_set)
+      continue;
+
+    eliminated_.push_back(c);
+    Jacobian A = c->GetJacobian();
+    VectorXd rhs = -(c->GetValues() - A*x_init);
+    VecBound b = c->GetBounds();
+
+    for (int k=0; k<A.outerSize(); ++k) {
+      Row row;
+      double scale = 0.0;
+      for (Jacobian::InnerIterator it(A, k); it; ++it) {
+        row[it.col()] = it.value();
+        scale = std::max(scale, std::abs(it.value()));
+      }
+
+      double r = rhs(k) + b.at(k).lower_;
+      row = substitute(row, r);
+
+      int p = -1;
+      double max = 0.0;
+      for (const auto& a : row)
+        max = std::max(max, std::abs(a.second));
+
+      if (max < 1e-9*scale) {
+        if (std::abs(r) > 1e-6*std::max(1.0, scale))
+          throw std::runtime_error("NullSpaceReduction: inconsistent row "
+                                   + std::to_string(k) + " of " + c->GetName());
+        continue; // redundant
+      }
+
+      // prefer large pivots, then variables without bounds.
+      for (const auto& a : row) {
+        if (std::abs(a.second) < 0.5*max)
+          continue;
+        if (p == -1 || (is_bounded(p) && !is_bounded(a.first))
+            || (is_bounded(p) == is_bounded(a.first)
+                && std::abs(a.second) > std::abs(row.at(p))))
+          p = a.first;
+      }
+
+      for (auto it=row.begin(); it!=row.end();) {
+        if (it->first != p && std::abs(it->second) < 1e-12*max)
+          it = row.erase(it);
+        else
+          ++it;
+      }
+
+      eliminate(p, row, r);
+    }
+  }
+
+  // x = x0 + Z*y
+  std::vector<int> col(n, -1);
+  VectorXd y_init;
+  VecBound y_bounds;
+  std::vector<int> bounded_basic;
+  for (int i=0; i<n; ++i) {
+    if (!is_basic.at(i)) {
+      col.at(i) = y_bounds.size();
+      y_bounds.push_back(bounds.at(i));
+    }
+    else if (is_bounded(i) && bounds.at(i).lower_ != bounds.at(i).upper_)
+      bounded_basic.push_back(i);
+  }
+
+  x0_ = VectorXd::Zero(n);
+  y_init = VectorXd::Zero(y_bounds.size());
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (int i=0; i<n; ++i) {
+    if (is_basic.at(i)) {
+      x0_(i) = expr_const.at(i);
+      for (const auto& e : expr.at(i))
+        triplets.push_back(Eigen::Triplet<double>(i, col.at(e.first), e.second));
+    }
+    else {
+      y_init(col.at(i)) = x_init(i);
+      triplets.push_back(Eigen::Triplet<double>(i, col.at(i), 1.0));
+    }
+  }
+  Z_.resize(n, y_bounds.size());
+  Z_.setFromTriplets(triplets.begin(), triplets.end());
+  Z_.makeCompressed();
+
+  y_ = std::make_shared<ReducedVariables>(x_, x0_, Z_, y_init, y_bounds);
+  y_->SetVariables(y_init);
+
+  for (int i=0; i<static_cast<int>(constraints.size()); ++i)
+    if (!is_eliminated.at(i))
+      constraints_.push_back(std::make_shared<ReducedConstraint>(constraints.at(i), Z_));
+
+  if (!bounded_basic.empty())
+    constraints_.push_back(std::make_shared<ReducedVariableBounds>(x_, bounded_basic, Z_));
+
+  for (const auto& c : costs)
+    costs_.push_back(std::make_shared<ReducedCost>(c, Z_));
+}
+
+ifopt::VariableSet::Ptr
+NullSpaceReduction::GetVariables () const
+{
+  return y_;
+}
+
+NullSpaceReduction::ContraintPtrVec
+NullSpaceReduction::GetConstraints () const
+{
+  return constraints_;
+}
+
+NullSpaceReduction::ContraintPtrVec
+NullSpaceReduction::GetCosts () const
+{
+  return costs_;
+}
+
+NullSpaceReduction::VectorXd
+NullSpaceReduction::GetFullVariables (const VectorXd& y) const
+{
+  return x0_ + Z_*y;
+}
+
+NullSpaceReduction::MultiplierMap
+NullSpaceReduction::GetEliminatedMultipliers (const VectorXd& grad) const
+{
+  // A_E^T * mu = -grad, with the rows A_E of the eliminated equalities
+  int n = x_->GetRows();
+  std::vector<Eigen::Triplet<double>> triplets;
+  int row = 0;
+  for (const auto& c : eliminated_) {
+    Jacobian A = c->GetJacobian();
+    for (int k=0; k<A.outerSize(); ++k)
+      for (Jacobian::InnerIterator it(A, k); it; ++it)
+        triplets.push_back(Eigen::Triplet<double>(it.col(), row+it.row(), it.value()));
+    row += c->GetRows();
+  }
+  for (int id : fixed_ids_)
+    triplets.push_back(Eigen::Triplet<double>(id, row++, 1.0));
+
+  Eigen::SparseMatrix<double> AT(n, row);
+  AT.setFromTriplets(triplets.begin(), triplets.end());
+  AT.makeCompressed();
+
+  Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> qr(AT);
+  VectorXd mu = qr.solve(VectorXd(-grad));
+
+  MultiplierMap multipliers;
+  row = 0;
+  for (const auto& c : eliminated_) {
+    multipliers[c->GetName()] = mu.segment(row, c->GetRows());
+    row += c->GetRows();
+  }
+
+  VectorXd mu_fixed = VectorXd::Zero(n);
+  for (int id : fixed_ids_)
+    mu_fixed(id) = mu(row++);
+
+  int col = 0;
+  for (const auto& v : x_->GetComponents()) {
+    multipliers[v->GetName()] = mu_fixed.segment(col, v->GetRows());
+    col += v->GetRows();
+  }
+
+  return multipliers;
+}
+
+} /* namespace towr */
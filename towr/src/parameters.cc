@@ -46,10 +46,15 @@ Parameters::Parameters ()
 
   // parameters related to specific constraints (only used when it is added as well)
   force_limit_in_normal_direction_ = 1000;
+  force_in_friction_cone_basis_ = false; // xyz-forces with ForceConstraint
   dt_constraint_range_of_motion_ = 0.08;
   dt_constraint_dynamic_ = 0.1;
   dt_constraint_base_motion_ = duration_base_polynomial_/4.; // only for base RoM constraint
+  collocation_points_per_segment_ = 0; // uniform dt_constraint_.. instead
   bound_phase_duration_ = std::make_pair(0.2, 1.0);  // used only when optimizing phase durations, so gait
+  n_threads_ = 1; // evaluate constraints on the calling thread only
+  evaluate_sets_in_parallel_ = false;
+  reduce_null_space_ = false;
 
   // a minimal set of basic constraints
   constraints_.push_back(Terrain);
@@ -97,6 +102,20 @@ Parameters::GetBasePolyDurations () const
   return base_spline_timings_;
 }
 
+Parameters::VecTimes
+Parameters::GetCollocationSegmentEdges () const
+{
+  // the base polynomials are too short to be worth their own segments.
+  VecTimes edges = {0.0};
+  for (const auto& durations : ee_phase_durations_) {
+    double t = 0.0;
+    for (double d : durations)
+      edges.push_back(t += d);
+  }
+
+  return edges;
+}
+
 int
 Parameters::GetPhaseCount(EEID ee) const
 {
@@ -134,4 +153,11 @@ Parameters::IsOptimizeTimings () const
   return std::find(v.begin(), v.end(), c) != v.end();
 }
 
+bool
+Parameters::IsFiniteDifferenceConstraint (ConstraintName c) const
+{
+  auto v = finite_difference_constraints_; // shorthand
+  return std::find(v.begin(), v.end(), c) != v.end();
+}
+
 } // namespace towr
@@ -91,11 +91,15 @@ PhaseDurations::SetVariables (const VectorXd& x)
   // implementation is still required. PR desired ;)
   assert(t_total_>x.sum());
 
+  if (x == GetValues())
+    return; // nothing changed, so splines can stay as they are
+
   for (int i=0; i<GetRows(); ++i)
     durations_.at(i) = x(i);
 
   // last phase duration not optimized, used to fill up to total time.
   durations_.back() =  t_total_ - x.sum();
+  version_++;
   UpdateObservers();
 }
 
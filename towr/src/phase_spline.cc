@@ -54,14 +54,35 @@ PhaseSpline::PhaseSpline(
 void
 PhaseSpline::UpdatePolynomialDurations()
 {
-  auto phase_duration = phase_durations_->GetPhaseDurations();
-  auto poly_durations = phase_nodes_->ConvertPhaseToPolyDurations(phase_duration);
+  durations_outdated_ = true;
+}
 
-  for (int i=0; i<cubic_polys_.size(); ++i) {
-    cubic_polys_.at(i).SetDuration(poly_durations.at(i));
+void
+PhaseSpline::UpdateIfOutdated() const
+{
+  // the spline only caches what the phase durations define, so it is still
+  // logically const. Never actually a const object, so the cast is safe.
+  // Threads querying concurrently wait until the first one has applied them.
+  if (durations_outdated_) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    if (durations_outdated_)
+      const_cast<PhaseSpline*>(this)->ApplyPhaseDurations();
   }
+}
 
+void
+PhaseSpline::ApplyPhaseDurations()
+{
+  auto phase_duration = phase_durations_->GetPhaseDurations();
+  auto poly_durations = phase_nodes_->ConvertPhaseToPolyDurations(phase_duration);
+
+  SetPolyDurations(poly_durations);
   UpdatePolynomialCoeff();
+
+  // Jacobians w.r.t. nodes at a global time depend on the durations
+  ClearPrecomputedJacobians();
+
+  durations_outdated_ = false;
 }
 
 PhaseSpline::Jacobian
@@ -78,7 +99,7 @@ Eigen::VectorXd
 PhaseSpline::GetDerivativeOfPosWrtPhaseDuration (double t_global) const
 {
   int poly_id; double t_local;
-  std::tie(poly_id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(poly_id, t_local) = GetLocalTime(t_global);
 
   VectorXd vel  = GetPoint(t_global).v();
   VectorXd dxdT = cubic_polys_.at(poly_id).GetDerivativeOfPosWrtDuration(t_local);
@@ -53,9 +53,14 @@ State Polynomial::GetPoint(double t_local) const
   int n_dim = coeff_.front().size();
   State out(n_dim, 3);
 
-  for (auto d : {kPos, kVel, kAcc})
-    for (Coefficients c : coeff_ids_)
-      out.at(d) += GetDerivativeWrtCoeff(t_local, d, c)*coeff_.at(c);
+  // Horner's scheme, highest coefficient first, so no powers of t needed.
+  for (int c=coeff_.size()-1; c>=A; --c) {
+    out.at(kPos) = t_local*out.at(kPos) + coeff_[c];
+    if (c >= B)
+      out.at(kVel) = t_local*out.at(kVel) + c*coeff_[c];
+    if (c >= C)
+      out.at(kAcc) = t_local*out.at(kAcc) + c*(c-1)*coeff_[c];
+  }
 
   return out;
 }
@@ -99,8 +104,8 @@ CubicHermitePolynomial::UpdateCoeff()
 {
   coeff_[A] =  n0_.p();
   coeff_[B] =  n0_.v();
-  coeff_[C] = -( 3*(n0_.p() - n1_.p()) +  T_*(2*n0_.v() + n1_.v()) ) / std::pow(T_,2);
-  coeff_[D] =  ( 2*(n0_.p() - n1_.p()) +  T_*(  n0_.v() + n1_.v()) ) / std::pow(T_,3);
+  coeff_[C] = -( 3*(n0_.p() - n1_.p()) +  T_*(2*n0_.v() + n1_.v()) ) / (T_*T_);
+  coeff_[D] =  ( 2*(n0_.p() - n1_.p()) +  T_*(  n0_.v() + n1_.v()) ) / (T_*T_*T_);
 }
 
 double
@@ -141,11 +146,11 @@ double
 CubicHermitePolynomial::GetDerivativeOfPosWrtStartNode(Dx node_value,
                                                        double t) const
 {
-  double t2 = std::pow(t,2);
-  double t3 = std::pow(t,3);
+  double t2 = t*t;
+  double t3 = t2*t;
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return (2*t3)/T3 - (3*t2)/T2 + 1;
@@ -158,10 +163,10 @@ double
 CubicHermitePolynomial::GetDerivativeOfVelWrtStartNode (Dx node_value,
                                                         double t) const
 {
-  double t2 = std::pow(t,2);
+  double t2 = t*t;
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return (6*t2)/T3 - (6*t)/T2;
@@ -175,8 +180,8 @@ CubicHermitePolynomial::GetDerivativeOfAccWrtStartNode (Dx node_value,
                                                         double t) const
 {
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return (12*t)/T3 - 6/T2;
@@ -189,11 +194,11 @@ double
 CubicHermitePolynomial::GetDerivativeOfPosWrtEndNode (Dx node_value,
                                                       double t) const
 {
-  double t2 = std::pow(t,2);
-  double t3 = std::pow(t,3);
+  double t2 = t*t;
+  double t3 = t2*t;
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return (3*t2)/T2 - (2*t3)/T3;
@@ -206,10 +211,10 @@ double
 CubicHermitePolynomial::GetDerivativeOfVelWrtEndNode (Dx node_value,
                                                       double t) const
 {
-  double t2 = std::pow(t,2);
+  double t2 = t*t;
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return (6*t)/T2 - (6*t2)/T3;
@@ -223,8 +228,8 @@ CubicHermitePolynomial::GetDerivativeOfAccWrtEndNode (Dx node_value,
                                                       double t) const
 {
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
+  double T2 = T*T;
+  double T3 = T2*T;
 
   switch (node_value) {
     case kPos: return 6/T2 - (12*t)/T3;
@@ -241,12 +246,12 @@ CubicHermitePolynomial::GetDerivativeOfPosWrtDuration(double t) const
   VectorXd v0 = n0_.v();
   VectorXd v1 = n1_.v();
 
-  double t2 = std::pow(t,2);
-  double t3 = std::pow(t,3);
+  double t2 = t*t;
+  double t3 = t2*t;
   double T  = T_;
-  double T2 = std::pow(T_,2);
-  double T3 = std::pow(T_,3);
-  double T4 = std::pow(T_,4);
+  double T2 = T*T;
+  double T3 = T2*T;
+  double T4 = T3*T;
 
   VectorXd deriv = (t3*(v0 + v1))/T3
                  - (t2*(2*v0 + v1))/T2
@@ -36,47 +36,107 @@ RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& mod
                                                   double T, double dt,
                                                   const EE& ee,
                                                   const SplineHolder& spline_holder)
-    :TimeDiscretizationConstraint(T, dt, "rangeofmotion-" + std::to_string(ee))
+    :RangeOfMotionConstraint(model, GetUniformTimes(T, dt), ee, spline_holder)
+{
+}
+
+RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& model,
+                                                  const VecTimes& dts,
+                                                  const EE& ee,
+                                                  const SplineHolder& spline_holder)
+    :RangeOfMotionConstraint(model, dts, std::vector<EE>{ee}, spline_holder,
+                             "rangeofmotion-" + std::to_string(ee))
+{
+}
+
+RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& model,
+                                                  const VecTimes& dts,
+                                                  const std::vector<EE>& ees,
+                                                  const SplineHolder& spline_holder)
+    :RangeOfMotionConstraint(model, dts, ees, spline_holder, "rangeofmotion")
+{
+}
+
+RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& model,
+                                                  const VecTimes& dts,
+                                                  const std::vector<EE>& ees,
+                                                  const SplineHolder& spline_holder,
+                                                  const std::string& name)
+    :TimeDiscretizationConstraint(dts, name)
 {
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
-  ee_motion_    = spline_holder.ee_motion_.at(ee);
+  base_angular_ = spline_holder.base_orientation_;
 
   max_deviation_from_nominal_ = model->GetMaximumDeviationFromNominal();
-  nominal_ee_pos_B_           = model->GetNominalStanceInBase().at(ee);
-  ee_ = ee;
 
-  SetRows(GetNumberOfNodes()*k3D);
+  ees_ = ees;
+  for (auto ee : ees_) {
+    ee_motion_.push_back(spline_holder.ee_motion_.at(ee));
+    nominal_ee_pos_B_.push_back(model->GetNominalStanceInBase().at(ee));
+  }
+
+  // with fixed durations these only depend on the time, so compute once
+  base_linear_->PrecomputeJacobiansWrtNodes(dts_, kPos);
+  spline_holder.base_angular_->PrecomputeJacobiansWrtNodes(dts_, kPos);
+  for (auto& ee_motion : ee_motion_)
+    ee_motion->PrecomputeJacobiansWrtNodes(dts_, kPos);
+
+  SetRows(GetNumberOfNodes()*ees_.size()*k3D);
 }
 
 int
-RangeOfMotionConstraint::GetRow (int node, int dim) const
+RangeOfMotionConstraint::GetRow (int node, int i, int dim) const
 {
-  return node*k3D + dim;
+  return (node*ees_.size() + i)*k3D + dim;
+}
+
+RangeOfMotionConstraint::VectorXd
+RangeOfMotionConstraint::GetValues () const
+{
+  VectorXd g = VectorXd::Zero(GetRows());
+
+  auto base_W = base_linear_->GetPoints<k3D>(dts_);
+  std::vector<decltype(base_W)> pos_ee_W;
+  for (const auto& ee_motion : ee_motion_)
+    pos_ee_W.push_back(ee_motion->GetPoints<k3D>(dts_));
+
+  ForEachInstance([&](double t, int k) {
+    Eigen::Matrix3d b_R_w = base_angular_->GetRotationMatrixBaseToWorldDense(t).transpose();
+    for (int i=0; i<static_cast<int>(ees_.size()); ++i) {
+      Vector3d vector_base_to_ee_W = pos_ee_W.at(i).p().col(k) - base_W.p().col(k);
+      g.middleRows(GetRow(k, i, X), k3D) = b_R_w*vector_base_to_ee_W;
+    }
+  });
+
+  return g;
 }
 
 void
 RangeOfMotionConstraint::UpdateConstraintAtInstance (double t, int k, VectorXd& g) const
 {
-  Vector3d base_W  = base_linear_->GetPoint(t).p();
-  Vector3d pos_ee_W = ee_motion_->GetPoint(t).p();
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
+  Vector3d base_W  = base_linear_->GetPoint<k3D>(t).p();
+  Eigen::Matrix3d b_R_w = base_angular_->GetRotationMatrixBaseToWorldDense(t).transpose();
 
-  Vector3d vector_base_to_ee_W = pos_ee_W - base_W;
-  Vector3d vector_base_to_ee_B = b_R_w*(vector_base_to_ee_W);
+  for (int i=0; i<static_cast<int>(ees_.size()); ++i) {
+    Vector3d pos_ee_W = ee_motion_.at(i)->GetPoint<k3D>(t).p();
+    Vector3d vector_base_to_ee_W = pos_ee_W - base_W;
+    Vector3d vector_base_to_ee_B = b_R_w*(vector_base_to_ee_W);
 
-  g.middleRows(GetRow(k, X), k3D) = vector_base_to_ee_B;
+    g.middleRows(GetRow(k, i, X), k3D) = vector_base_to_ee_B;
+  }
 }
 
 void
 RangeOfMotionConstraint::UpdateBoundsAtInstance (double t, int k, VecBound& bounds) const
 {
-  for (int dim=0; dim<k3D; ++dim) {
-    ifopt::Bounds b;
-    b += nominal_ee_pos_B_(dim);
-    b.upper_ += max_deviation_from_nominal_(dim);
-    b.lower_ -= max_deviation_from_nominal_(dim);
-    bounds.at(GetRow(k,dim)) = b;
+  for (int i=0; i<static_cast<int>(ees_.size()); ++i) {
+    for (int dim=0; dim<k3D; ++dim) {
+      ifopt::Bounds b;
+      b += nominal_ee_pos_B_.at(i)(dim);
+      b.upper_ += max_deviation_from_nominal_(dim);
+      b.lower_ -= max_deviation_from_nominal_(dim);
+      bounds.at(GetRow(k,i,dim)) = b;
+    }
   }
 }
 
@@ -85,26 +145,33 @@ RangeOfMotionConstraint::UpdateJacobianAtInstance (double t, int k,
                                                    std::string var_set,
                                                    Jacobian& jac) const
 {
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
-  int row_start = GetRow(k,X);
+  Eigen::Matrix3d b_R_w = base_angular_->GetRotationMatrixBaseToWorldDense(t).transpose();
 
   if (var_set == id::base_lin_nodes) {
-    jac.middleRows(row_start, k3D) = -1*b_R_w*base_linear_->GetJacobianWrtNodes(t, kPos);
+    // the same for every endeffector, whose rows follow each other
+    Eigen::MatrixXd M = (-b_R_w).replicate(ees_.size(), 1);
+    base_linear_->FillJacobianWrtNodes(t, kPos, M, GetRow(k,0,X), jac);
   }
 
   if (var_set == id::base_ang_nodes) {
-    Vector3d base_W   = base_linear_->GetPoint(t).p();
-    Vector3d ee_pos_W = ee_motion_->GetPoint(t).p();
-    Vector3d r_W = ee_pos_W - base_W;
-    jac.middleRows(row_start, k3D) = base_angular_.DerivOfRotVecMult(t,r_W, true);
+    Vector3d base_W = base_linear_->GetPoint<k3D>(t).p();
+    for (int i=0; i<static_cast<int>(ees_.size()); ++i) {
+      Vector3d r_W = ee_motion_.at(i)->GetPoint<k3D>(t).p() - base_W;
+      jac.middleRows(GetRow(k,i,X), k3D) = base_angular_->DerivOfRotVecMult(t,r_W, true);
+    }
   }
 
-  if (var_set == id::EEMotionNodes(ee_)) {
-    jac.middleRows(row_start, k3D) = b_R_w*ee_motion_->GetJacobianWrtNodes(t,kPos);
-  }
+  for (int i=0; i<static_cast<int>(ees_.size()); ++i) {
+    int row_start = GetRow(k,i,X);
+
+    if (var_set == id::EEMotionNodes(ees_.at(i))) {
+      ee_motion_.at(i)->FillJacobianWrtNodes(t, kPos, b_R_w, row_start, jac);
+    }
 
-  if (var_set == id::EESchedule(ee_)) {
-    jac.middleRows(row_start, k3D) = b_R_w*ee_motion_->GetJacobianOfPosWrtDurations(t);
+    if (var_set == id::EESchedule(ees_.at(i))) {
+      EulerConverter::MatrixSXd b_R_w_sparse = b_R_w.sparseView(1.0, -1.0);
+      jac.middleRows(row_start, k3D) = b_R_w_sparse*ee_motion_.at(i)->GetJacobianOfPosWrtDurations(t);
+    }
   }
 }
 
@@ -44,16 +44,48 @@ static Eigen::Matrix3d BuildInertiaTensor( double Ixx, double Iyy, double Izz,
 }
 
 // builds a cross product matrix out of "in", so in x v = X(in)*v
-SingleRigidBodyDynamics::Jac
+static Eigen::Matrix3d
 Cross(const Eigen::Vector3d& in)
 {
-  SingleRigidBodyDynamics::Jac out(3,3);
+  Eigen::Matrix3d out;
+  out <<     0.0, -in(2),  in(1),
+           in(2),    0.0, -in(0),
+          -in(1),  in(0),    0.0;
+  return out;
+}
 
-  out.coeffRef(0,1) = -in(2); out.coeffRef(0,2) =  in(1);
-  out.coeffRef(1,0) =  in(2); out.coeffRef(1,2) = -in(0);
-  out.coeffRef(2,0) = -in(1); out.coeffRef(2,1) =  in(0);
+// The entries of a 3x3 matrix that take part in a product with a Jacobian,
+// independent of their current value. This way the sparsity structure of
+// the Jacobians never changes during the iterations.
+using Mask = Eigen::Matrix<bool, k3D, k3D>;
+static const Mask kFull     = Mask::Constant(true);
+static const Mask kDiagonal = Mask::Identity();
+static const Mask kCross    = (Eigen::Matrix3d::Ones()
+                               - Eigen::Matrix3d::Identity()).cast<bool>();
+
+// adds M*jac_in to the three rows of jac starting at row.
+static void
+AddProduct (const Eigen::Matrix3d& M, const Mask& mask,
+            const SingleRigidBodyDynamics::Jac& jac_in,
+            int row, SingleRigidBodyDynamics::Jac& jac)
+{
+  for (int c=0; c<k3D; ++c)
+    for (SingleRigidBodyDynamics::Jac::InnerIterator it(jac_in, c); it; ++it)
+      for (int r=0; r<k3D; ++r)
+        if (mask(r,c))
+          jac.coeffRef(row+r, it.col()) += M(r,c)*it.value();
+}
 
-  return out;
+// creates a 6xn Jacobian through one of the Fill..() functions.
+template<typename F>
+static SingleRigidBodyDynamics::Jac
+CreateJacobian (int n, int nnz_per_row, F fill)
+{
+  SingleRigidBodyDynamics::Jac jac(k6D, n);
+  jac.reserve(Eigen::VectorXi::Constant(k6D, nnz_per_row));
+  fill(jac);
+  jac.makeCompressed();
+  return jac;
 }
 
 SingleRigidBodyDynamics::SingleRigidBodyDynamics (double mass,
@@ -70,33 +102,114 @@ SingleRigidBodyDynamics::SingleRigidBodyDynamics (double mass, const Eigen::Matr
                                   int ee_count)
     :DynamicModel(mass, ee_count)
 {
-  I_b = inertia_b.sparseView();
+  I_b = inertia_b;
+  UpdateDerivedQuantities();
+}
+
+SingleRigidBodyDynamics::Ptr
+SingleRigidBodyDynamics::Clone () const
+{
+  return std::make_shared<SingleRigidBodyDynamics>(*this);
+}
+
+void
+SingleRigidBodyDynamics::UpdateDerivedQuantities ()
+{
+  // express inertia matrix in world frame based on current body orientation
+  R_I_b_     = w_R_b_*I_b;
+  I_w_       = R_I_b_*w_R_b_.transpose();
+  I_w_omega_ = I_w_*omega_;
+
+  omega_x_ = Cross(omega_);
+  omega_x_R_I_b_ = omega_x_*R_I_b_;
+  omega_x_I_w_minus_I_w_omega_x_ = omega_x_*I_w_ - Cross(I_w_omega_);
+
+  f_sum_.setZero(); tau_sum_.setZero();
+  for (int ee=0; ee<ee_count_; ++ee) {
+    const Vector3d& f = ee_force_.at(ee);
+    Vector3d r = com_pos_ - ee_pos_.at(ee);
+    tau_sum_ += f.cross(r);
+    f_sum_   += f;
+
+    f_x_.at(ee) = Cross(f);
+    r_x_.at(ee) = Cross(r);
+  }
+  f_sum_x_ = Cross(f_sum_);
 }
 
 SingleRigidBodyDynamics::BaseAcc
 SingleRigidBodyDynamics::GetDynamicViolation () const
 {
   // https://en.wikipedia.org/wiki/Newton%E2%80%93Euler_equations
+  BaseAcc acc;
+  acc.segment(AX, k3D) = I_w_*omega_dot_
+                         + omega_.cross(I_w_omega_)
+                         - tau_sum_;
+  acc.segment(LX, k3D) = m()*com_acc_
+                         - f_sum_
+                         - Vector3d(0.0, 0.0, -m()*g()); // gravity force
+  return acc;
+}
 
-  Vector3d f_sum, tau_sum;
-  f_sum.setZero(); tau_sum.setZero();
+// the rows of a x b, where every column of a and b is one sample
+static SingleRigidBodyDynamics::Samples::Rows
+CrossRows (const SingleRigidBodyDynamics::Samples::Rows& a,
+           const SingleRigidBodyDynamics::Samples::Rows& b)
+{
+  SingleRigidBodyDynamics::Samples::Rows c(k3D, a.cols());
+  c.row(X) = a.row(Y)*b.row(Z) - a.row(Z)*b.row(Y);
+  c.row(Y) = a.row(Z)*b.row(X) - a.row(X)*b.row(Z);
+  c.row(Z) = a.row(X)*b.row(Y) - a.row(Y)*b.row(X);
+  return c;
+}
 
-  for (int ee=0; ee<ee_pos_.size(); ++ee) {
-    Vector3d f = ee_force_.at(ee);
-    tau_sum += f.cross(com_pos_ - ee_pos_.at(ee));
+SingleRigidBodyDynamics::BaseAccs
+SingleRigidBodyDynamics::GetDynamicViolations (const Samples& s)
+{
+  using Rows = Samples::Rows;
+  int n = s.GetCount();
+  const Rows& R = s.w_R_b_;
+
+  // I_w*v = R*I_b*R^T*v for the angular velocity/acceleration of every sample
+  auto InertiaTimes = [&](const Rows& v) {
+    Rows v_b = Rows::Zero(k3D, n);
+    for (int i=0; i<k3D; ++i)
+      for (int j=0; j<k3D; ++j)
+        v_b.row(j) += R.row(3*i+j)*v.row(i);
+
+    Rows I_v_b = Rows::Zero(k3D, n);
+    for (int i=0; i<k3D; ++i)
+      for (int j=0; j<k3D; ++j)
+        if (I_b(i,j) != 0.0)
+          I_v_b.row(i) += I_b(i,j)*v_b.row(j);
+
+    Rows I_v = Rows::Zero(k3D, n);
+    for (int i=0; i<k3D; ++i)
+      for (int j=0; j<k3D; ++j)
+        I_v.row(i) += R.row(3*i+j)*I_v_b.row(j);
+
+    return I_v;
+  };
+
+  // sum_i f_i x (com - p_i) and sum_i f_i
+  Rows tau_sum = Rows::Zero(k3D, n);
+  Rows f_sum   = Rows::Zero(k3D, n);
+  for (int ee=0; ee<ee_count_; ++ee) {
+    Rows f = s.ee_force_.middleRows(3*ee, k3D);
+    Rows r = s.com_pos_ - s.ee_pos_.middleRows(3*ee, k3D);
+    tau_sum += CrossRows(f, r);
     f_sum   += f;
   }
 
-  // express inertia matrix in world frame based on current body orientation
-  Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
+  Rows ang = InertiaTimes(s.omega_dot_)
+             + CrossRows(s.omega_, InertiaTimes(s.omega_))
+             - tau_sum;
+  Rows lin = m()*s.com_acc_ - f_sum;
+  lin.row(Z) += m()*g(); // gravity force
 
-  BaseAcc acc;
-  acc.segment(AX, k3D) = I_w*omega_dot_
-                         + Cross(omega_)*(I_w*omega_)
-                         - tau_sum;
-  acc.segment(LX, k3D) = m()*com_acc_
-                         - f_sum
-                         - Vector3d(0.0, 0.0, -m()*g()); // gravity force
+  BaseAccs acc(k6D, n);
+  acc.middleRows(AX, k3D) = ang.matrix();
+  acc.middleRows(LX, k3D) = lin.matrix();
   return acc;
 }
 
@@ -104,40 +217,65 @@ SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtBaseLin (const Jac& jac_pos_base_lin,
                                         const Jac& jac_acc_base_lin) const
 {
-  // build the com jacobian
-  int n = jac_pos_base_lin.cols();
-
-  Jac jac_tau_sum(k3D, n);
-  for (const Vector3d& f : ee_force_) {
-    Jac jac_tau = Cross(f)*jac_pos_base_lin;
-    jac_tau_sum += jac_tau;
-  }
-
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = -jac_tau_sum;
-  jac.middleRows(LX, k3D) = m()*jac_acc_base_lin;
-
-  return jac;
+  int nnz = jac_pos_base_lin.nonZeros() + jac_acc_base_lin.nonZeros();
+  return CreateJacobian(jac_pos_base_lin.cols(), nnz, [&](Jac& jac) {
+    FillJacobianWrtBaseLin(jac_pos_base_lin, jac_acc_base_lin, 0, jac);
+  });
 }
 
 SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtBaseAng (const EulerConverter& base_euler,
                                         double t) const
 {
-  Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
+  Jac jac_ang_vel = base_euler.GetDerivOfAngVelWrtEulerNodes(t);
+  return CreateJacobian(jac_ang_vel.cols(), jac_ang_vel.nonZeros(), [&](Jac& jac) {
+    FillJacobianWrtBaseAng(base_euler, t, 0, jac);
+  });
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtForce (const Jac& jac_force, EE ee) const
+{
+  return CreateJacobian(jac_force.cols(), jac_force.nonZeros(), [&](Jac& jac) {
+    FillJacobianWrtForce(jac_force, ee, 0, jac);
+  });
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee) const
+{
+  return CreateJacobian(jac_ee_pos.cols(), jac_ee_pos.nonZeros(), [&](Jac& jac) {
+    FillJacobianWrtEEPos(jac_ee_pos, ee, 0, jac);
+  });
+}
+
+void
+SingleRigidBodyDynamics::FillJacobianWrtBaseLin (const Jac& jac_pos_base_lin,
+                                                 const Jac& jac_acc_base_lin,
+                                                 int row, Jac& jac) const
+{
+  // derivative of the torques, sum_i f_i x (com - p_i)
+  AddProduct(-f_sum_x_, kCross, jac_pos_base_lin, row+AX, jac);
+  AddProduct(m()*Matrix3d::Identity(), kDiagonal, jac_acc_base_lin, row+LX, jac);
+}
 
+void
+SingleRigidBodyDynamics::FillJacobianWrtBaseAng (const EulerConverter& base_euler,
+                                                 double t, int row, Jac& jac) const
+{
   // Derivative of R*I_b*R^T * wd
   // 1st term of product rule (derivative of R)
   Vector3d v11 = I_b*w_R_b_.transpose()*omega_dot_;
   Jac jac11 = base_euler.DerivOfRotVecMult(t, v11, false);
+  AddProduct(Matrix3d::Identity(), kDiagonal, jac11, row+AX, jac);
 
   // 2nd term of product rule (derivative of R^T)
-  Jac jac12 = w_R_b_.sparseView()*I_b*base_euler.DerivOfRotVecMult(t, omega_dot_, true);
+  Jac jac12 = base_euler.DerivOfRotVecMult(t, omega_dot_, true);
+  AddProduct(R_I_b_, kFull, jac12, row+AX, jac);
 
   // 3rd term of product rule (derivative of wd)
   Jac jac_ang_acc = base_euler.GetDerivOfAngAccWrtEulerNodes(t);
-  Jac jac13 = I_w * jac_ang_acc;
-  Jac jac1 = jac11 + jac12 + jac13;
+  AddProduct(I_w_, kFull, jac_ang_acc, row+AX, jac);
 
 
   // Derivative of w x Iw
@@ -145,50 +283,33 @@ SingleRigidBodyDynamics::GetJacobianWrtBaseAng (const EulerConverter& base_euler
   // right derivative same as above, just with velocity instead acceleration
   Vector3d v21 = I_b*w_R_b_.transpose()*omega_;
   Jac jac21 = base_euler.DerivOfRotVecMult(t, v21, false);
+  AddProduct(omega_x_, kCross, jac21, row+AX, jac);
 
   // 2nd term of product rule (derivative of R^T)
-  Jac jac22 = w_R_b_.sparseView()*I_b*base_euler.DerivOfRotVecMult(t, omega_, true);
+  Jac jac22 = base_euler.DerivOfRotVecMult(t, omega_, true);
+  AddProduct(omega_x_R_I_b_, kFull, jac22, row+AX, jac);
 
-  // 3rd term of product rule (derivative of omega)
+  // 3rd term of product rule (derivative of omega), combined with the
+  // derivative of the left factor
   Jac jac_ang_vel = base_euler.GetDerivOfAngVelWrtEulerNodes(t);
-  Jac jac23 = I_w * jac_ang_vel;
-
-  Jac jac2 = Cross(omega_)*(jac21+jac22+jac23) - Cross(I_w*omega_)*jac_ang_vel;
-
-
-  // Combine the two to get sensitivity to I_w*w + w x (I_w*w)
-  int n = jac_ang_vel.cols();
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = jac1 + jac2;
-
-  return jac;
+  AddProduct(omega_x_I_w_minus_I_w_omega_x_, kFull, jac_ang_vel, row+AX, jac);
 }
 
-SingleRigidBodyDynamics::Jac
-SingleRigidBodyDynamics::GetJacobianWrtForce (const Jac& jac_force, EE ee) const
+void
+SingleRigidBodyDynamics::FillJacobianWrtForce (const Jac& jac_force, EE ee,
+                                               int row, Jac& jac) const
 {
-  Vector3d r = com_pos_ - ee_pos_.at(ee);
-  Jac jac_tau = -Cross(r)*jac_force;
-
-  int n = jac_force.cols();
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = -jac_tau;
-  jac.middleRows(LX, k3D) = -jac_force;
-
-  return jac;
+  AddProduct(r_x_.at(ee), kCross, jac_force, row+AX, jac);
+  AddProduct(-Matrix3d::Identity(), kDiagonal, jac_force, row+LX, jac);
 }
 
-SingleRigidBodyDynamics::Jac
-SingleRigidBodyDynamics::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee) const
+void
+SingleRigidBodyDynamics::FillJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee,
+                                               int row, Jac& jac) const
 {
-  Vector3d f = ee_force_.at(ee);
-  Jac jac_tau = Cross(f)*(-jac_ee_pos);
-
-  Jac jac(k6D, jac_tau.cols());
-  jac.middleRows(AX, k3D) = -jac_tau;
+  AddProduct(f_x_.at(ee), kCross, jac_ee_pos, row+AX, jac);
 
   // linear dynamics don't depend on endeffector position.
-  return jac;
 }
 
 } /* namespace towr */
@@ -29,7 +29,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/spline.h>
 
-#include <numeric> // std::accumulate
+#include <algorithm> // std::lower_bound
+#include <cassert>
 
 namespace towr {
 
@@ -38,13 +39,24 @@ Spline::Spline(const VecTimes& poly_durations, int n_dim)
   uint n_polys = poly_durations.size();
 
   cubic_polys_.assign(n_polys, CubicHermitePolynomial(n_dim));
-  for (int i=0; i<cubic_polys_.size(); ++i) {
-    cubic_polys_.at(i).SetDuration(poly_durations.at(i));
-  }
+  SetPolyDurations(poly_durations);
 
   UpdatePolynomialCoeff();
 }
 
+void
+Spline::SetPolyDurations (const VecTimes& durations)
+{
+  poly_end_times_.resize(durations.size());
+
+  double t = 0.0;
+  for (int i=0; i<static_cast<int>(cubic_polys_.size()); ++i) {
+    cubic_polys_.at(i).SetDuration(durations.at(i));
+    t += durations.at(i);
+    poly_end_times_.at(i) = t;
+  }
+}
+
 int
 Spline::GetSegmentID(double t_global, const VecTimes& durations)
 {
@@ -66,22 +78,45 @@ Spline::GetSegmentID(double t_global, const VecTimes& durations)
 }
 
 std::pair<int,double>
-Spline::GetLocalTime (double t_global, const VecTimes& durations) const
+Spline::GetLocalTime (double t_global) const
 {
-  int id = GetSegmentID(t_global, durations);
+  double eps = 1e-10; // double precision, same convention as GetSegmentID()
+  assert(t_global >= 0.0);
+  UpdateIfOutdated();
+
+  // at junctions, returns previous spline, so first polynomial with end >= t
+  double t = t_global-eps;
+  int last = poly_end_times_.size()-1;
+
+  // start at the segment of the previous query, unless t lies before it
+  int lo = segment_hint_.load(std::memory_order_relaxed);
+  if (lo > last || (lo > 0 && poly_end_times_.at(lo-1) >= t))
+    lo = 0;
+
+  // gallop forward to bracket the segment, then bisect inside the bracket
+  int hi = lo;
+  int step = 1;
+  while (hi < last && poly_end_times_.at(hi) < t) {
+    lo = hi+1;
+    hi = std::min(hi+step, last);
+    step *= 2;
+  }
 
-  double t_local = t_global;
-  for (int i=0; i<id; i++)
-    t_local -= durations.at(i);
+  auto begin = poly_end_times_.begin();
+  int id = std::lower_bound(begin+lo, begin+hi+1, t) - begin;
+  assert(id <= last); // t_global beyond total time of spline
+  id = std::min(id, last);
 
-  return std::make_pair(id, t_local);
+  segment_hint_.store(id, std::memory_order_relaxed);
+  double t_start = id==0? 0.0 : poly_end_times_.at(id-1);
+  return std::make_pair(id, t_global - t_start);
 }
 
 const State
 Spline::GetPoint(double t_global) const
 {
   int id; double t_local;
-  std::tie(id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(id, t_local) = GetLocalTime(t_global);
 
   return GetPoint(id, t_local);
 }
@@ -89,6 +124,7 @@ Spline::GetPoint(double t_global) const
 const State
 Spline::GetPoint(int poly_id, double t_local) const
 {
+  UpdateIfOutdated();
   return cubic_polys_.at(poly_id).GetPoint(t_local);
 }
 
@@ -97,6 +133,22 @@ Spline::UpdatePolynomialCoeff()
 {
   for (auto& p : cubic_polys_)
     p.UpdateCoeff();
+
+  version_++;
+}
+
+void
+Spline::UpdatePolynomialCoeff(int poly_id)
+{
+  cubic_polys_.at(poly_id).UpdateCoeff();
+  version_++;
+}
+
+int
+Spline::GetVersion () const
+{
+  UpdateIfOutdated();
+  return version_;
 }
 
 int
@@ -108,6 +160,8 @@ Spline::GetPolynomialCount () const
 Spline::VecTimes
 Spline::GetPolyDurations() const
 {
+  UpdateIfOutdated();
+
   VecTimes poly_durations;
   for (const auto& p : cubic_polys_)
     poly_durations.push_back(p.GetDuration());
@@ -118,8 +172,8 @@ Spline::GetPolyDurations() const
 double
 Spline::GetTotalTime() const
 {
-  auto v = GetPolyDurations();
-  return std::accumulate(v.begin(), v.end(), 0.0);
+  UpdateIfOutdated();
+  return poly_end_times_.empty()? 0.0 : poly_end_times_.back();
 }
 
 } /* namespace towr */
@@ -29,40 +29,110 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/state.h>
 
+#include <cassert>
+
 
 namespace towr {
 
 State::State (int dim, int n_derivatives)
 {
-  values_ = std::vector<VectorXd>(n_derivatives, VectorXd::Zero(dim));
+  dim_ = dim;
+  n_derivatives_ = n_derivatives;
+  owned_values_ = VectorXd::Zero(dim*n_derivatives);
+  values_ = owned_values_.data();
+}
+
+State::State (double* data, int dim, int n_derivatives)
+{
+  dim_ = dim;
+  n_derivatives_ = n_derivatives;
+  values_ = data;
+}
+
+State::State (const State& other)
+{
+  dim_ = other.dim_;
+  n_derivatives_ = other.n_derivatives_;
+  owned_values_ = ConstVectorMap(other.values_, dim_*n_derivatives_);
+  values_ = owned_values_.data();
+}
+
+State&
+State::operator= (const State& other)
+{
+  if (this == &other)
+    return *this;
+
+  ConstVectorMap other_values(other.values_, other.dim_*other.n_derivatives_);
+
+  // views keep referring to the same values
+  if (values_ == owned_values_.data()) {
+    owned_values_ = other_values;
+    values_ = owned_values_.data();
+  }
+  else {
+    assert(dim_ == other.dim_ && n_derivatives_ == other.n_derivatives_);
+    VectorMap(values_, dim_*n_derivatives_) = other_values;
+  }
+
+  dim_ = other.dim_;
+  n_derivatives_ = other.n_derivatives_;
+  return *this;
+}
+
+State::ConstVectorMap
+State::at (Dx deriv) const&
+{
+  assert(deriv < n_derivatives_);
+  return ConstVectorMap(values_ + deriv*dim_, dim_);
 }
 
-const Eigen::VectorXd
-State::at (Dx deriv) const
+State::VectorXd
+State::at (Dx deriv) const&&
 {
-  return values_.at(deriv);
+  assert(deriv < n_derivatives_);
+  return ConstVectorMap(values_ + deriv*dim_, dim_);
 }
 
-Eigen::VectorXd&
-State::at (Dx deriv)
+State::VectorMap
+State::at (Dx deriv) &
 {
-  return values_.at(deriv);
+  assert(deriv < n_derivatives_);
+  return VectorMap(values_ + deriv*dim_, dim_);
 }
 
-const Eigen::VectorXd
-State::p () const
+State::ConstVectorMap
+State::p () const&
 {
   return at(kPos);
 }
 
-const Eigen::VectorXd
-State::v () const
+State::VectorXd
+State::p () const&&
+{
+  return at(kPos);
+}
+
+State::ConstVectorMap
+State::v () const&
+{
+  return at(kVel);
+}
+
+State::VectorXd
+State::v () const&&
 {
   return at(kVel);
 }
 
-const Eigen::VectorXd
-State::a () const
+State::ConstVectorMap
+State::a () const&
+{
+  return at(kAcc);
+}
+
+State::VectorXd
+State::a () const&&
 {
   return at(kAcc);
 }
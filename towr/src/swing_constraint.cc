@@ -57,10 +57,10 @@ SwingConstraint::GetValues () const
   VectorXd g(GetRows());
 
   int row = 0;
-  auto nodes = ee_motion_->GetNodes();
+  const auto& nodes = ee_motion_->GetNodes();
   for (int node_id : pure_swing_node_ids_) {
     // assumes two splines per swingphase and starting and ending in stance
-    auto curr = nodes.at(node_id);
+    const Node& curr = nodes.at(node_id);
 
     Vector2d prev = nodes.at(node_id-1).p().topRows<k2D>();
     Vector2d next = nodes.at(node_id+1).p().topRows<k2D>();
@@ -50,6 +50,8 @@ TerrainConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
   for (int id=1; id<ee_motion_->GetNodes().size(); ++id)
     node_ids_.push_back(id);
 
+  terrain_frames_ = std::make_shared<TerrainFrames>(terrain_, ee_motion_);
+
   int constraint_count = node_ids_.size();
   SetRows(constraint_count);
 }
@@ -59,11 +61,11 @@ TerrainConstraint::GetValues () const
 {
   VectorXd g(GetRows());
 
-  auto nodes = ee_motion_->GetNodes();
+  const auto& nodes = ee_motion_->GetNodes();
   int row = 0;
   for (int id : node_ids_) {
-    Vector3d p = nodes.at(id).p();
-    g(row++) = p.z() - terrain_->GetHeight(p.x(), p.y());
+    double z = nodes.at(id).p().z();
+    g(row++) = z - terrain_frames_->GetFrame(id).height_;
   }
 
   return g;
@@ -91,16 +93,15 @@ void
 TerrainConstraint::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
   if (var_set == ee_motion_->GetName()) {
-    auto nodes = ee_motion_->GetNodes();
     int row = 0;
     for (int id : node_ids_) {
       int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(id, kPos, Z));
       jac.coeffRef(row, idx) = 1.0;
 
-      Vector3d p = nodes.at(id).p();
+      const auto& frame = terrain_frames_->GetFrame(id);
       for (auto dim : {X,Y}) {
         int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(id, kPos, dim));
-        jac.coeffRef(row, idx) = -terrain_->GetDerivativeOfHeightWrt(To2D(dim), p.x(), p.y());
+        jac.coeffRef(row, idx) = -frame.dheight_[To2D(dim)];
       }
       row++;
     }
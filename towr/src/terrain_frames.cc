@@ -0,0 +1,81 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/terrain/terrain_frames.h>
+
+namespace towr {
+
+TerrainFrames::TerrainFrames (const HeightMap::Ptr& terrain,
+                              const NodesVariables::Ptr& ee_motion)
+{
+  terrain_   = terrain;
+  ee_motion_ = ee_motion;
+
+  using NodeValueInfo = NodesVariables::NodeValueInfo;
+  auto shares_xy = [&](int id1, int id2) {
+    for (auto dim : {X,Y}) {
+      int idx = ee_motion->GetOptIndex(NodeValueInfo(id1, kPos, dim));
+      if (idx == NodesVariables::NodeValueNotOptimized
+          || idx != ee_motion->GetOptIndex(NodeValueInfo(id2, kPos, dim)))
+        return false;
+    }
+    return true;
+  };
+
+  int n_frames = 0;
+  int n_nodes = ee_motion->GetNodes().size();
+  for (int id=0; id<n_nodes; ++id) {
+    if (id>0 && shares_xy(id-1, id))
+      frame_ids_.push_back(frame_ids_.back());
+    else
+      frame_ids_.push_back(n_frames++);
+  }
+
+  frames_.resize(n_frames);
+  frame_xy_.resize(n_frames);
+  frame_valid_.resize(n_frames, false);
+}
+
+const TerrainFrames::Frame&
+TerrainFrames::GetFrame (int node_id) const
+{
+  int f = frame_ids_.at(node_id);
+  Eigen::Vector2d xy = ee_motion_->GetNodes().at(node_id).p().topRows<k2D>();
+
+  if (!frame_valid_.at(f) || frame_xy_.at(f) != xy) {
+    frames_.at(f) = terrain_->GetFrame(xy.x(), xy.y());
+    frame_xy_.at(f) = xy;
+    frame_valid_.at(f) = true;
+  }
+
+  return frames_.at(f);
+}
+
+} /* namespace towr */
@@ -0,0 +1,152 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+
+#include <towr/thread_pool.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace towr {
+
+static thread_local int thread_index = 0;
+static thread_local bool in_parallel_loop = false;
+
+ThreadPool::ThreadPool (int n_threads)
+{
+  assert(n_threads >= 1);
+
+  // index 0 is the thread calling ParallelFor()
+  for (int i=1; i<n_threads; ++i)
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool ()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+
+  for (auto& w : workers_)
+    w.join();
+}
+
+int
+ThreadPool::GetThreadCount () const
+{
+  return workers_.size()+1;
+}
+
+int
+ThreadPool::GetThreadIndex ()
+{
+  return thread_index;
+}
+
+bool
+ThreadPool::IsInParallelLoop ()
+{
+  return in_parallel_loop;
+}
+
+void
+ThreadPool::ParallelFor (int n, const std::function<void(int)>& f)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // nested or single-threaded loops run on the calling thread
+  if (running_ || workers_.empty() || n <= 1) {
+    lock.unlock();
+    for (int i=0; i<n; ++i)
+      f(i);
+    return;
+  }
+
+  // a few chunks per thread, so threads that finish early can help out
+  f_     = &f;
+  n_     = n;
+  chunk_ = std::max(1, n/(4*GetThreadCount()));
+  next_  = 0;
+  running_ = true;
+  busy_workers_ = workers_.size();
+  generation_++;
+  lock.unlock();
+  work_available_.notify_all();
+
+  RunChunks();
+
+  lock.lock();
+  work_done_.wait(lock, [&]{ return busy_workers_ == 0; });
+  running_ = false;
+  f_ = nullptr;
+}
+
+void
+ThreadPool::RunChunks ()
+{
+  in_parallel_loop = true;
+
+  int begin;
+  while ((begin = next_.fetch_add(chunk_)) < n_) {
+    int end = std::min(begin+chunk_, n_);
+    for (int i=begin; i<end; ++i)
+      (*f_)(i);
+  }
+
+  in_parallel_loop = false;
+}
+
+void
+ThreadPool::WorkerLoop (int index)
+{
+  thread_index = index;
+  int generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [&]{ return stop_ || generation_ != generation; });
+      if (stop_)
+        return;
+      generation = generation_;
+    }
+
+    RunChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_--;
+    }
+    work_done_.notify_one();
+  }
+}
+
+} /* namespace towr */
@@ -29,6 +29,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/constraints/time_discretization_constraint.h>
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 
 namespace towr {
@@ -36,24 +38,84 @@ namespace towr {
 
 TimeDiscretizationConstraint::TimeDiscretizationConstraint (double T, double dt,
                                                             std::string name)
-    :ConstraintSet(kSpecifyLater, name)
+    :TimeDiscretizationConstraint(GetUniformTimes(T, dt), name)
+{
+}
+
+TimeDiscretizationConstraint::TimeDiscretizationConstraint (const VecTimes& times,
+                                                            std::string name)
+   :ConstraintSet(kSpecifyLater, name) // just placeholder
+{
+  dts_ = times;
+}
+
+TimeDiscretizationConstraint::VecTimes
+TimeDiscretizationConstraint::GetUniformTimes (double T, double dt)
 {
   double t = 0.0;
-  dts_ = {t};
+  VecTimes dts = {t};
 
   for (int i=0; i<floor(T/dt); ++i) {
     t += dt;
-    dts_.push_back(t);
+    dts.push_back(t);
   }
 
-  dts_.push_back(T); // also ensure constraints at very last node/time.
+  // also ensure constraints at very last node/time, but only once, even if
+  // the last multiple of dt only hits T up to rounding.
+  if (T - dts.back() < 1e-6*dt)
+    dts.pop_back();
+  dts.push_back(T);
+
+  return dts;
 }
 
-TimeDiscretizationConstraint::TimeDiscretizationConstraint (const VecTimes& times,
-                                                            std::string name)
-   :ConstraintSet(kSpecifyLater, name) // just placeholder
+TimeDiscretizationConstraint::VecTimes
+TimeDiscretizationConstraint::GetCollocationTimes (const VecTimes& segment_edges,
+                                                   int n_points)
 {
-  dts_ = times;
+  assert(n_points >= 2);
+  const double eps = 1e-6;
+
+  VecTimes edges = segment_edges;
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end(),
+                          [&](double a, double b) { return b - a < eps; }),
+              edges.end());
+
+  // Gauss-Lobatto points on [-1,1] are the edges and the roots of the
+  // derivative of the Legendre polynomial P_N, found by Newton's method
+  // starting from the Chebyshev-Gauss-Lobatto points.
+  int N = n_points-1;
+  std::vector<double> x(n_points);
+  for (int i=0; i<n_points; ++i)
+    x.at(i) = std::cos(M_PI*i/N);
+
+  for (int i=1; i<N; ++i) {
+    for (int iter=0; iter<100; ++iter) {
+      double p_prev = 1.0, p = x.at(i); // P_{k-1}, P_k
+      for (int k=2; k<=N; ++k) {
+        double p_next = ((2*k-1)*x.at(i)*p - (k-1)*p_prev)/k;
+        p_prev = p;
+        p = p_next;
+      }
+      double dx = (x.at(i)*p - p_prev)/((N+1)*p);
+      x.at(i) -= dx;
+      if (std::abs(dx) < 1e-15)
+        break;
+    }
+  }
+
+  VecTimes dts;
+  for (int s=0; s+1<static_cast<int>(edges.size()); ++s) {
+    double t0 = edges.at(s);
+    double T  = edges.at(s+1) - t0;
+    int first = s==0? 0 : 1; // the start is the end of the previous segment
+    for (int i=first; i<N; ++i)
+      dts.push_back(t0 + (1.0-x.at(i))/2.0*T);
+    dts.push_back(edges.at(s+1)); // exactly, not up to rounding
+  }
+
+  return dts;
 }
 
 int
@@ -62,14 +124,39 @@ TimeDiscretizationConstraint::GetNumberOfNodes () const
   return dts_.size();
 }
 
+void
+TimeDiscretizationConstraint::SetThreadPool (const ThreadPool::Ptr& pool)
+{
+  thread_pool_ = pool;
+}
+
+int
+TimeDiscretizationConstraint::GetThreadCount () const
+{
+  return thread_pool_? thread_pool_->GetThreadCount() : 1;
+}
+
+void
+TimeDiscretizationConstraint::ForEachInstance (
+    const std::function<void(double t, int k)>& f) const
+{
+  PrepareEvaluation();
+
+  if (thread_pool_)
+    thread_pool_->ParallelFor(dts_.size(), [&](int k) { f(dts_.at(k), k); });
+  else
+    for (int k=0; k<GetNumberOfNodes(); ++k)
+      f(dts_.at(k), k);
+}
+
 TimeDiscretizationConstraint::VectorXd
 TimeDiscretizationConstraint::GetValues () const
 {
   VectorXd g = VectorXd::Zero(GetRows());
 
-  int k = 0;
-  for (double t : dts_)
-    UpdateConstraintAtInstance(t, k++, g);
+  ForEachInstance([&](double t, int k) {
+    UpdateConstraintAtInstance(t, k, g);
+  });
 
   return g;
 }
@@ -90,9 +177,49 @@ void
 TimeDiscretizationConstraint::FillJacobianBlock (std::string var_set,
                                                   Jacobian& jac) const
 {
-  int k = 0;
-  for (double t : dts_)
-    UpdateJacobianAtInstance(t, k++, var_set, jac);
+  auto row_nnz = jac_row_nnz_.find(var_set);
+
+  // the first time fill serially, to record the sparsity structure
+  if (row_nnz == jac_row_nnz_.end()) {
+    PrepareEvaluation();
+    int k = 0;
+    for (double t : dts_)
+      UpdateJacobianAtInstance(t, k++, var_set, jac);
+
+    Eigen::VectorXi nnz(jac.rows());
+    for (int row=0; row<jac.rows(); ++row)
+      nnz(row) = jac.innerVector(row).nonZeros();
+    jac_row_nnz_[var_set] = nnz;
+    return;
+  }
+
+  jac.reserve(row_nnz->second);
+
+  // already evaluated in parallel with other constraints, so fill in place
+  int n_blocks = ThreadPool::IsInParallelLoop()? 1 : GetThreadCount();
+  if (n_blocks == 1) {
+    ForEachInstance([&](double t, int k) {
+      UpdateJacobianAtInstance(t, k, var_set, jac);
+    });
+    return;
+  }
+
+  // consecutive instances are filled into one block by the same thread
+  int n = dts_.size();
+  std::vector<Jacobian> blocks(n_blocks, Jacobian(jac.rows(), jac.cols()));
+  PrepareEvaluation();
+  thread_pool_->ParallelFor(n_blocks, [&](int b) {
+    Jacobian& block = blocks.at(b);
+    block.reserve(row_nnz->second);
+    for (int k=b*n/n_blocks; k<(b+1)*n/n_blocks; ++k)
+      UpdateJacobianAtInstance(dts_.at(k), k, var_set, block);
+  });
+
+  // merge in order of the blocks, so the result is always the same
+  for (const Jacobian& block : blocks)
+    for (int row=0; row<block.outerSize(); ++row)
+      for (Jacobian::InnerIterator it(block, row); it; ++it)
+        jac.coeffRef(row, it.col()) += it.value();
 }
 
 } /* namespace towr */
@@ -27,6 +27,8 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
+#include <cstdlib>
+
 #include <gtest/gtest.h>
 
 #include <towr/models/single_rigid_body_dynamics.h>
@@ -48,4 +50,43 @@ TEST(DynamicModelTest, TestRotations)
   // update test
 }
 
+TEST(DynamicModelTest, GetDynamicViolations)
+{
+  int n_ee = 4;
+  int n = 11; // not a multiple of any vector width
+  SingleRigidBodyDynamics model(20.0, 1.2, 5.5, 6.0, 0.1, -0.2, 0.3, n_ee);
+
+  std::srand(0);
+  DynamicModel::Samples s;
+  s.Resize(n, n_ee);
+  s.com_pos_.setRandom();
+  s.com_acc_.setRandom();
+  s.omega_.setRandom();
+  s.omega_dot_.setRandom();
+  s.ee_force_.setRandom();
+  s.ee_pos_.setRandom();
+  for (int k=0; k<n; ++k) {
+    Eigen::Vector3d euler = Eigen::Vector3d::Random();
+    s.SetRotation(k, EulerConverter::GetRotationMatrixBaseToWorld(euler));
+  }
+
+  DynamicModel::BaseAccs batch = model.GetDynamicViolations(s);
+
+  ASSERT_EQ(6, batch.rows());
+  ASSERT_EQ(n, batch.cols());
+  for (int k=0; k<n; ++k) {
+    DynamicModel::EEVectors force, pos;
+    for (int ee=0; ee<n_ee; ++ee) {
+      force.at(ee) = s.ee_force_.col(k).segment<3>(3*ee);
+      pos.at(ee)   = s.ee_pos_.col(k).segment<3>(3*ee);
+    }
+    model.SetCurrent(s.com_pos_.col(k).matrix(), s.com_acc_.col(k).matrix(),
+                     s.GetRotation(k),
+                     s.omega_.col(k).matrix(), s.omega_dot_.col(k).matrix(),
+                     force, pos);
+
+    EXPECT_TRUE(batch.col(k).isApprox(model.GetDynamicViolation(), 1e-12));
+  }
+}
+
 } /* namespace xpp */
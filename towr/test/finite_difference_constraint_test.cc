@@ -0,0 +1,93 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "walking_formulation.h"
+
+namespace towr {
+
+using VectorXd = Eigen::VectorXd;
+using Jacobian = ifopt::Component::Jacobian;
+
+// the Jacobian of all constraints at a perturbed initial guess.
+static Jacobian
+GetJacobian (bool finite_difference, int n_threads)
+{
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Anymal, 2.0,
+                                                     std::make_shared<Slope>());
+  Parameters& params = formulation.params_;
+  params.OptimizePhaseDurations();
+  params.constraints_.push_back(Parameters::BaseAcc);
+  params.constraints_.push_back(Parameters::BaseRom);
+  params.n_threads_ = n_threads;
+  if (finite_difference)
+    params.finite_difference_constraints_ = params.constraints_;
+
+  ifopt::Problem nlp;
+  SplineHolder splines;
+  AddToProblem(formulation, splines, nlp);
+
+  std::srand(0);
+  int n = nlp.GetNumberOfOptimizationVariables();
+  VectorXd x = nlp.GetVariableValues() + 0.01*VectorXd::Random(n);
+  nlp.EvaluateConstraints(x.data());
+  return nlp.GetJacobianOfConstraints();
+}
+
+static void
+ExpectNear (const Jacobian& analytic, const Jacobian& numeric)
+{
+  ASSERT_EQ(analytic.rows(), numeric.rows());
+  ASSERT_EQ(analytic.cols(), numeric.cols());
+
+  // the columns are perturbed in groups, so any entry of another column
+  // in the same row would show up here.
+  Eigen::MatrixXd a = analytic;
+  Eigen::MatrixXd b = numeric;
+  for (int row=0; row<a.rows(); ++row)
+    for (int col=0; col<a.cols(); ++col)
+      ASSERT_NEAR(a(row,col), b(row,col), 1e-6*std::max(1.0, std::abs(a(row,col))))
+          << "row " << row << ", col " << col;
+}
+
+TEST(FiniteDifferenceConstraintTest, MatchesAnalyticJacobian)
+{
+  ExpectNear(GetJacobian(false, 1), GetJacobian(true, 1));
+}
+
+TEST(FiniteDifferenceConstraintTest, MatchesAnalyticJacobianOnSeveralThreads)
+{
+  ExpectNear(GetJacobian(false, 1), GetJacobian(true, 4));
+}
+
+} /* namespace towr */
@@ -99,28 +99,36 @@ int main()
   cout << fixed;
   cout << "\n====================\nMonoped trajectory:\n====================\n";
 
-  double t = 0.0;
-  while (t<=solution.base_linear_->GetTotalTime() + 1e-5) {
+  std::vector<double> times;
+  for (double t=0.0; t<=solution.base_linear_->GetTotalTime() + 1e-5; t+=0.2)
+    times.push_back(t);
+
+  // query each spline at all sample times at once
+  auto base_lin = solution.base_linear_->GetPoints<3>(times);
+  auto base_ang = solution.base_angular_->GetPoints<3>(times);
+  auto foot_pos = solution.ee_motion_.at(0)->GetPoints<3>(times);
+  auto foot_frc = solution.ee_force_.at(0)->GetPoints<3>(times);
+
+  for (int k=0; k<static_cast<int>(times.size()); ++k) {
+    double t = times.at(k);
     cout << "t=" << t << "\n";
     cout << "Base linear position x,y,z:   \t";
-    cout << solution.base_linear_->GetPoint(t).p().transpose() << "\t[m]" << endl;
+    cout << base_lin.p().col(k).transpose() << "\t[m]" << endl;
 
     cout << "Base Euler roll, pitch, yaw:  \t";
-    Eigen::Vector3d rad = solution.base_angular_->GetPoint(t).p();
+    Eigen::Vector3d rad = base_ang.p().col(k);
     cout << (rad/M_PI*180).transpose() << "\t[deg]" << endl;
 
     cout << "Foot position x,y,z:          \t";
-    cout << solution.ee_motion_.at(0)->GetPoint(t).p().transpose() << "\t[m]" << endl;
+    cout << foot_pos.p().col(k).transpose() << "\t[m]" << endl;
 
     cout << "Contact force x,y,z:          \t";
-    cout << solution.ee_force_.at(0)->GetPoint(t).p().transpose() << "\t[N]" << endl;
+    cout << foot_frc.p().col(k).transpose() << "\t[N]" << endl;
 
     bool contact = solution.phase_durations_.at(0)->IsContactPhase(t);
     std::string foot_in_contact = contact? "yes" : "no";
     cout << "Foot in contact:              \t" + foot_in_contact << endl;
 
     cout << endl;
-
-    t += 0.2;
   }
 }
@@ -0,0 +1,80 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "walking_formulation.h"
+
+namespace towr {
+
+using VectorXd = Eigen::VectorXd;
+
+TEST(NlpFormulationTest, SameResultOnSeveralThreads)
+{
+  NlpFormulation serial = GetWalkingFormulation(RobotModel::Anymal, 1.0);
+  serial.params_.OptimizePhaseDurations();
+
+  NlpFormulation parallel = GetWalkingFormulation(RobotModel::Anymal, 1.0);
+  parallel.params_.OptimizePhaseDurations();
+  parallel.params_.n_threads_ = 4;
+  parallel.params_.evaluate_sets_in_parallel_ = true;
+
+  SplineHolder serial_splines, parallel_splines;
+  ifopt::Problem serial_nlp, parallel_nlp;
+  AddToProblem(serial, serial_splines, serial_nlp);
+  AddToProblem(parallel, parallel_splines, parallel_nlp);
+
+  int n = serial_nlp.GetNumberOfOptimizationVariables();
+  ASSERT_EQ(n, parallel_nlp.GetNumberOfOptimizationVariables());
+  ASSERT_EQ(serial_nlp.GetNumberOfConstraints(), parallel_nlp.GetNumberOfConstraints());
+
+  // the first Jacobian is filled serially to record its structure, so
+  // compare several evaluations.
+  std::srand(0);
+  for (int i=0; i<3; ++i) {
+    VectorXd x = serial_nlp.GetVariableValues() + 0.01*VectorXd::Random(n);
+
+    VectorXd g = serial_nlp.EvaluateConstraints(x.data());
+    EXPECT_TRUE(g.isApprox(parallel_nlp.EvaluateConstraints(x.data()), 1e-12));
+
+    Eigen::MatrixXd jac = serial_nlp.GetJacobianOfConstraints();
+    Eigen::MatrixXd jac_parallel = parallel_nlp.GetJacobianOfConstraints();
+    EXPECT_LT((jac - jac_parallel).cwiseAbs().maxCoeff(), 1e-12*jac.cwiseAbs().maxCoeff());
+
+    EXPECT_NEAR(serial_nlp.EvaluateCostFunction(x.data()),
+                parallel_nlp.EvaluateCostFunction(x.data()), 1e-12);
+
+    VectorXd grad = serial_nlp.EvaluateCostFunctionGradient(x.data());
+    EXPECT_TRUE(grad.isApprox(parallel_nlp.EvaluateCostFunctionGradient(x.data()), 1e-12));
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,90 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include <towr/variables/node_spline.h>
+#include <towr/variables/nodes_variables_all.h>
+
+#include "walking_formulation.h"
+
+namespace towr {
+
+using Jacobian = NodeSpline::Jacobian;
+
+static void
+ExpectStackedJacobians (const NodeSpline& spline, const Spline::VecTimes& times)
+{
+  for (auto dxdt : {kPos, kVel, kAcc}) {
+    Jacobian stacked = spline.GetJacobiansWrtNodes(times, dxdt);
+    int n_dim = spline.GetPoint(0.0).p().rows();
+    ASSERT_EQ(static_cast<int>(times.size())*n_dim, stacked.rows());
+    ASSERT_EQ(spline.GetNodeVariablesCount(), stacked.cols());
+
+    for (int k=0; k<static_cast<int>(times.size()); ++k) {
+      Jacobian single = spline.GetJacobianWrtNodes(times.at(k), dxdt);
+      Jacobian block  = stacked.middleRows(k*n_dim, n_dim);
+      EXPECT_EQ(single.nonZeros(), block.nonZeros()) << times.at(k);
+      EXPECT_LT(Eigen::MatrixXd(single - block).cwiseAbs().maxCoeff(), 1e-12)
+          << times.at(k);
+    }
+  }
+}
+
+TEST(NodeSplineTest, GetJacobiansWrtNodes)
+{
+  auto nodes = std::make_shared<NodesVariablesAll>(4, k3D, "nodes");
+  std::srand(0);
+  nodes->SetVariables(Eigen::VectorXd::Random(nodes->GetRows()));
+  NodeSpline spline(nodes.get(), {0.3, 0.4, 0.5});
+
+  // ascending, with polynomial edges, and some out of order
+  ExpectStackedJacobians(spline, {0.0, 0.1, 0.3, 0.35, 0.7, 1.0, 1.2, 0.2, 0.0});
+}
+
+TEST(NodeSplineTest, GetJacobiansWrtNodesOfPhaseSpline)
+{
+  SplineHolder splines;
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Biped, 0.5);
+  auto variables = formulation.GetVariableSets(splines); // owns the nodes
+
+  // phase-based nodes, where one variable sets several node values
+  Spline::VecTimes times;
+  double T = splines.ee_motion_.at(0)->GetTotalTime();
+  for (double t=0.0; t<T; t+=0.05)
+    times.push_back(t);
+  times.push_back(T);
+
+  ExpectStackedJacobians(*splines.ee_motion_.at(0), times);
+  ExpectStackedJacobians(*splines.ee_force_.at(0), times);
+}
+
+} /* namespace towr */
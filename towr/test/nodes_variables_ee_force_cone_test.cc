@@ -0,0 +1,122 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <towr/constraints/force_constraint.h>
+#include <towr/variables/variable_names.h>
+
+#include "walking_formulation.h"
+
+namespace towr {
+
+/**
+ * @brief An evenly sloped plane, whose tangents are not orthogonal.
+ */
+class TiltedPlane : public HeightMap {
+public:
+  double GetHeight(double x, double y) const override { return 0.3*x + 0.4*y; };
+  bool IsNormalConstant() const override { return true; };
+
+private:
+  double GetHeightDerivWrtX(double x, double y) const override { return 0.3; };
+  double GetHeightDerivWrtY(double x, double y) const override { return 0.4; };
+};
+
+TEST(NodesVariablesEEForceConeTest, EdgesSpanForceConstraintPyramid)
+{
+  auto terrain = std::make_shared<TiltedPlane>();
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Monoped, 0.2, terrain);
+  formulation.params_.force_in_friction_cone_basis_ = true;
+
+  SplineHolder splines;
+  auto x = std::make_shared<ifopt::Composite>("variables", false);
+  for (const auto& v : formulation.GetVariableSets(splines))
+    x->AddComponent(v);
+
+  auto force = x->GetComponent<NodesVariablesEEForceCone>(id::EEForceNodes(0));
+  ForceConstraint constraint(terrain, 1e6, 0);
+  constraint.LinkWithVariables(x);
+  auto bounds = constraint.GetBounds();
+  ASSERT_GT(constraint.GetRows(), 0);
+
+  std::vector<int> weight_ids;
+  auto var_bounds = force->GetBounds();
+  for (int idx=0; idx<force->GetRows(); ++idx)
+    if (var_bounds.at(idx).lower_ == 0.0)
+      weight_ids.push_back(idx);
+  ASSERT_EQ(0, static_cast<int>(weight_ids.size()) % NodesVariablesEEForceCone::n_edges);
+
+  // every single edge lies on two faces of the pyramid and inside the other two
+  for (int i=0; i<static_cast<int>(weight_ids.size()); ++i) {
+    Eigen::VectorXd w = Eigen::VectorXd::Zero(force->GetRows());
+    w(weight_ids.at(i)) = 1.0;
+    force->SetVariables(w);
+
+    Eigen::VectorXd g = constraint.GetValues();
+    int n_active = 0;
+    for (int row=0; row<g.rows(); ++row) {
+      EXPECT_GE(g(row), bounds.at(row).lower_ - 1e-12) << row;
+      EXPECT_LE(g(row), bounds.at(row).upper_ + 1e-12) << row;
+      if (std::abs(g(row)) < 1e-12)
+        n_active++;
+    }
+    // the other stance nodes have zero force and so satisfy all rows with equality
+    int n_zero_nodes = static_cast<int>(weight_ids.size())/NodesVariablesEEForceCone::n_edges - 1;
+    EXPECT_EQ(2 + 5*n_zero_nodes, n_active) << i;
+  }
+
+  // so does any nonnegative combination of them
+  std::srand(0);
+  Eigen::VectorXd w = Eigen::VectorXd::Random(force->GetRows());
+  for (int idx : weight_ids)
+    w(idx) = std::abs(w(idx));
+  force->SetVariables(w);
+
+  Eigen::VectorXd g = constraint.GetValues();
+  for (int row=0; row<g.rows(); ++row) {
+    EXPECT_GE(g(row), bounds.at(row).lower_ - 1e-12) << row;
+    EXPECT_LE(g(row), bounds.at(row).upper_ + 1e-12) << row;
+  }
+}
+
+TEST(NodesVariablesEEForceConeTest, ThrowsOnVaryingTerrainNormal)
+{
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Monoped, 0.2,
+                                                     std::make_shared<Gap>());
+  formulation.params_.force_in_friction_cone_basis_ = true;
+
+  SplineHolder splines;
+  EXPECT_THROW(formulation.GetVariableSets(splines), std::invalid_argument);
+}
+
+} /* namespace towr */
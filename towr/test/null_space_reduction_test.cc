@@ -0,0 +1,193 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdlib>
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include <towr/null_space_reduction.h>
+
+#include "walking_formulation.h"
+
+namespace towr {
+
+using VectorXd = Eigen::VectorXd;
+using Jacobian = ifopt::Component::Jacobian;
+
+TEST(NullSpaceReductionTest, ReducedProblemMatchesFullProblem)
+{
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Biped, 0.5);
+
+  // the problem on y
+  SplineHolder reduced_splines;
+  auto variables = formulation.GetVariableSets(reduced_splines);
+  NullSpaceReduction reduction(variables,
+                               formulation.GetConstraints(reduced_splines),
+                               formulation.GetCosts());
+  auto y = std::make_shared<ifopt::Composite>("variables", false);
+  y->AddComponent(reduction.GetVariables());
+  for (const auto& c : reduction.GetConstraints())
+    c->LinkWithVariables(y);
+  for (const auto& c : reduction.GetCosts())
+    c->LinkWithVariables(y);
+
+  // the same problem on x
+  SplineHolder full_splines;
+  auto x = std::make_shared<ifopt::Composite>("variables", false);
+  for (const auto& v : formulation.GetVariableSets(full_splines))
+    x->AddComponent(v);
+  std::map<std::string, ifopt::ConstraintSet::Ptr> constraints, costs;
+  for (const auto& c : formulation.GetConstraints(full_splines)) {
+    c->LinkWithVariables(x);
+    constraints[c->GetName()] = c;
+  }
+  for (const auto& c : formulation.GetCosts()) {
+    c->LinkWithVariables(x);
+    costs[c->GetName()] = c;
+  }
+
+  const Jacobian& Z = reduction.GetNullSpaceBasis();
+  ASSERT_EQ(x->GetRows(), Z.rows());
+  ASSERT_EQ(y->GetRows(), Z.cols());
+  ASSERT_LT(y->GetRows(), x->GetRows());
+
+  std::srand(0);
+  VectorXd y_values = y->GetValues() + 0.01*VectorXd::Random(y->GetRows());
+  y->SetVariables(y_values);
+  x->SetVariables(reduction.GetFullVariables(y_values));
+
+  // every remaining set is evaluated at x0 + Z*y
+  int n_compared = 0;
+  for (const auto& c : reduction.GetConstraints()) {
+    if (!constraints.count(c->GetName()))
+      continue; // the bounds of eliminated variables
+    const auto& full = constraints.at(c->GetName());
+    EXPECT_TRUE(c->GetValues().isApprox(full->GetValues(), 1e-10)) << c->GetName();
+
+    Eigen::MatrixXd jac = c->GetJacobian();
+    Eigen::MatrixXd jac_full = full->GetJacobian()*Z;
+    EXPECT_LT((jac - jac_full).cwiseAbs().maxCoeff(), 1e-10) << c->GetName();
+
+    constraints.erase(c->GetName());
+    n_compared++;
+  }
+  EXPECT_GT(n_compared, 0);
+
+  // the eliminated sets hold for any y
+  ASSERT_FALSE(constraints.empty());
+  for (const auto& c : constraints) {
+    VectorXd g = c.second->GetValues();
+    auto bounds = c.second->GetBounds();
+    for (int row=0; row<g.rows(); ++row)
+      EXPECT_NEAR(bounds.at(row).lower_, g(row), 1e-8) << c.first;
+  }
+
+  for (const auto& c : reduction.GetCosts()) {
+    const auto& full = costs.at(c->GetName());
+    EXPECT_NEAR(full->GetValues()(0), c->GetValues()(0), 1e-10);
+
+    Eigen::MatrixXd grad = c->GetJacobian();
+    Eigen::MatrixXd grad_full = full->GetJacobian()*Z;
+    EXPECT_LT((grad - grad_full).cwiseAbs().maxCoeff(), 1e-10) << c->GetName();
+  }
+}
+
+TEST(NullSpaceReductionTest, RecoversMultipliersOfFullProblem)
+{
+  NlpFormulation formulation = GetWalkingFormulation(RobotModel::Biped, 0.5);
+
+  SplineHolder reduced_splines;
+  auto variables = formulation.GetVariableSets(reduced_splines);
+  NullSpaceReduction reduction(variables,
+                               formulation.GetConstraints(reduced_splines),
+                               formulation.GetCosts());
+
+  // the full problem on x with multipliers for its eliminated equalities
+  SplineHolder full_splines;
+  auto x = std::make_shared<ifopt::Composite>("variables", false);
+  for (const auto& v : formulation.GetVariableSets(full_splines))
+    x->AddComponent(v);
+  std::map<std::string, ifopt::ConstraintSet::Ptr> eliminated;
+  for (const auto& c : formulation.GetConstraints(full_splines)) {
+    c->LinkWithVariables(x);
+    eliminated[c->GetName()] = c;
+  }
+  for (const auto& c : reduction.GetConstraints())
+    eliminated.erase(c->GetName());
+  ASSERT_FALSE(eliminated.empty());
+
+  std::srand(0);
+  int n = x->GetRows();
+  auto bounds = x->GetBounds();
+  VectorXd lambda_fixed = VectorXd::Zero(n);
+  for (int i=0; i<n; ++i)
+    if (bounds.at(i).lower_ == bounds.at(i).upper_)
+      lambda_fixed(i) = VectorXd::Random(1)(0);
+
+  // the stationarity of the full Lagrangian: grad + A_E^T*lambda_E + lambda_F = 0
+  std::map<std::string, VectorXd> lambda;
+  VectorXd grad = -lambda_fixed;
+  for (const auto& c : eliminated) {
+    lambda[c.first] = VectorXd::Random(c.second->GetRows());
+    grad -= c.second->GetJacobian().transpose()*lambda.at(c.first);
+  }
+
+  auto multipliers = reduction.GetEliminatedMultipliers(grad);
+
+  // the multipliers are unique only up to dependent rows, so compare the
+  // forces they exert on the variables rather than the values themselves
+  VectorXd force = VectorXd::Zero(n);
+  VectorXd force_full = lambda_fixed;
+  for (const auto& c : eliminated) {
+    ASSERT_TRUE(multipliers.count(c.first)) << c.first;
+    const VectorXd& mu = multipliers.at(c.first);
+    ASSERT_EQ(c.second->GetRows(), mu.rows());
+    Jacobian jac_t = c.second->GetJacobian().transpose();
+    force += jac_t*mu;
+    force_full += jac_t*lambda.at(c.first);
+  }
+
+  int col = 0;
+  for (const auto& v : x->GetComponents()) {
+    const VectorXd& mu = multipliers.at(v->GetName());
+    ASSERT_EQ(v->GetRows(), mu.rows());
+    force.segment(col, v->GetRows()) += mu;
+
+    // zero for every variable not fixed by its bounds
+    for (int i=0; i<v->GetRows(); ++i)
+      if (lambda_fixed(col+i) == 0.0)
+        EXPECT_EQ(0.0, mu(i)) << v->GetName();
+    col += v->GetRows();
+  }
+
+  EXPECT_LT((force - force_full).cwiseAbs().maxCoeff(), 1e-8);
+}
+
+} /* namespace towr */
@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <towr/constraints/time_discretization_constraint.h>
+
+namespace towr {
+
+using VecTimes = TimeDiscretizationConstraint::VecTimes;
+
+static void
+ExpectTimes (const VecTimes& expected, const VecTimes& times)
+{
+  ASSERT_EQ(expected.size(), times.size());
+  for (int i=0; i<static_cast<int>(times.size()); ++i)
+    EXPECT_NEAR(expected.at(i), times.at(i), 1e-12) << i;
+}
+
+TEST(TimeDiscretizationConstraintTest, GetUniformTimes)
+{
+  // 10*0.1 only hits 1.0 up to rounding, but 1.0 must be there only once
+  VecTimes times = TimeDiscretizationConstraint::GetUniformTimes(1.0, 0.1);
+  ASSERT_EQ(11, static_cast<int>(times.size()));
+  for (int i=0; i<10; ++i)
+    EXPECT_NEAR(0.1*i, times.at(i), 1e-12);
+  EXPECT_EQ(1.0, times.back());
+
+  ExpectTimes({0.0, 0.4, 0.8, 1.0},
+              TimeDiscretizationConstraint::GetUniformTimes(1.0, 0.4));
+}
+
+TEST(TimeDiscretizationConstraintTest, GetCollocationTimesGaussLobatto)
+{
+  // on [0,2] the points are 1+x of the Gauss-Lobatto points x on [-1,1]
+  VecTimes edges = {0.0, 2.0};
+  ExpectTimes({0.0, 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes(edges, 2));
+  ExpectTimes({0.0, 1.0, 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes(edges, 3));
+  ExpectTimes({0.0, 1.0-1.0/std::sqrt(5.0), 1.0+1.0/std::sqrt(5.0), 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes(edges, 4));
+  ExpectTimes({0.0, 1.0-std::sqrt(3.0/7.0), 1.0, 1.0+std::sqrt(3.0/7.0), 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes(edges, 5));
+}
+
+TEST(TimeDiscretizationConstraintTest, GetCollocationTimesOfSeveralSegments)
+{
+  // unsorted, with the shared edge only once
+  ExpectTimes({0.0, 0.5, 1.0, 2.0, 3.0},
+              TimeDiscretizationConstraint::GetCollocationTimes({3.0, 0.0, 1.0}, 3));
+
+  // edges closer than 1e-6 are merged, e.g. equal phase ends of two legs
+  ExpectTimes({0.0, 1.0, 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes({0.0, 1.0, 1.0+5e-7, 2.0, 2.0}, 2));
+  ExpectTimes({0.0, 1.0, 1.0+2e-6, 2.0},
+              TimeDiscretizationConstraint::GetCollocationTimes({0.0, 1.0, 1.0+2e-6, 2.0}, 2));
+}
+
+} /* namespace towr */
@@ -0,0 +1,90 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TEST_WALKING_FORMULATION_H_
+#define TOWR_TEST_WALKING_FORMULATION_H_
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+namespace towr {
+
+/**
+ * @brief A small walking problem shared by the tests.
+ *
+ * The robot starts in its nominal stance and moves its base forward by
+ * @a distance. Every endeffector starts in contact and alternates between
+ * stance and swing phases, and the forces are penalized.
+ */
+inline NlpFormulation
+GetWalkingFormulation (RobotModel::Robot robot, double distance,
+                       const HeightMap::Ptr& terrain = std::make_shared<FlatGround>(0.0))
+{
+  NlpFormulation formulation;
+  formulation.terrain_ = terrain;
+  formulation.model_ = RobotModel(robot);
+
+  auto nominal_stance_B = formulation.model_.kinematic_model_->GetNominalStanceInBase();
+  double z = -nominal_stance_B.front().z();
+  formulation.initial_base_.lin.at(kPos).z() = z;
+  formulation.final_base_.lin.at(kPos) << distance, 0.0, z;
+
+  formulation.initial_ee_W_ = nominal_stance_B;
+  for (auto& p : formulation.initial_ee_W_)
+    p.z() = terrain->GetHeight(p.x(), p.y());
+
+  for (auto& p : nominal_stance_B) {
+    formulation.params_.ee_phase_durations_.push_back({0.3, 0.2, 0.3, 0.2, 0.3});
+    formulation.params_.ee_in_contact_at_start_.push_back(true);
+  }
+  formulation.params_.costs_.push_back({Parameters::ForcesCostID, 1.0});
+
+  return formulation;
+}
+
+/**
+ * @brief Adds the variables, constraints and costs of @a formulation.
+ */
+inline void
+AddToProblem (const NlpFormulation& formulation, SplineHolder& splines,
+              ifopt::Problem& nlp)
+{
+  for (const auto& c : formulation.GetVariableSets(splines))
+    nlp.AddVariableSet(c);
+  for (const auto& c : formulation.GetConstraints(splines))
+    nlp.AddConstraintSet(c);
+  for (const auto& c : formulation.GetCosts())
+    nlp.AddCostSet(c);
+}
+
+} /* namespace towr */
+
+#endif /* TOWR_TEST_WALKING_FORMULATION_H_ */
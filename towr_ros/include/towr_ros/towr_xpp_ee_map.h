@@ -126,6 +126,20 @@ static xpp::StateLinXd ToXpp(const towr::State& towr)
   return xpp;
 }
 
+/**
+ * Converts the k-th sample of class "StateSamples" to an xpp state.
+ */
+static xpp::StateLinXd ToXpp(const towr::StateSamples<>& towr, int k)
+{
+  xpp::StateLinXd xpp(towr.p().rows());
+
+  xpp.p_ = towr.p().col(k);
+  xpp.v_ = towr.v().col(k);
+  xpp.a_ = towr.a().col(k);
+
+  return xpp;
+}
+
 } // namespace towr
 
 #endif /* TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_TOWR_XPP_EE_MAP_H_ */
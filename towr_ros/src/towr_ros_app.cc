@@ -97,9 +97,8 @@ public:
     // Analytically defining the derivatives in IFOPT as we do it, makes the
     // problem a lot faster. However, if this becomes too difficult, we can also
     // tell IPOPT to just approximate them using finite differences. However,
-    // this uses numerical derivatives for ALL constraints, there doesn't yet
-    // exist an option to turn on numerical derivatives for only some constraint
-    // sets.
+    // this uses numerical derivatives for ALL constraints. To use them for only
+    // some constraint sets, see Parameters::finite_difference_constraints_.
     solver_->SetOption("jacobian_approximation", "exact"); // finite difference-values
 
     // This is a great to test if the analytical derivatives implemented in are
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <xpp_msgs/TerrainInfo.h>
 
 #include <towr/terrain/height_map.h>
+#include <towr/null_space_reduction.h>
 #include <towr/variables/euler_converter.h>
 #include <towr_ros/topic_names.h>
 #include <towr_ros/towr_xpp_ee_map.h>
@@ -102,11 +103,28 @@ TowrRosInterface::UserCommandCallback(const TowrCommandMsg& msg)
   std::string bag_file = "towr_trajectory.bag";
   if (msg.optimize || msg.play_initialization) {
     nlp_ = ifopt::Problem();
-    for (auto c : formulation_.GetVariableSets(solution))
+    auto variables   = formulation_.GetVariableSets(solution);
+    auto constraints = formulation_.GetConstraints(solution);
+    auto costs       = formulation_.GetCosts();
+
+    // the solution splines still observe the full variables
+    if (formulation_.params_.reduce_null_space_) {
+      NullSpaceReduction reduction(variables, constraints, costs);
+      variables   = {reduction.GetVariables()};
+      constraints = reduction.GetConstraints();
+      costs       = reduction.GetCosts();
+    }
+
+    for (auto c : variables)
       nlp_.AddVariableSet(c);
-    for (auto c : formulation_.GetConstraints(solution))
+    for (auto c : constraints)
       nlp_.AddConstraintSet(c);
-    for (auto c : formulation_.GetCosts())
+
+    // the solver only evaluates a constant Jacobian once
+    auto yes_no = [](bool b) { return b? "yes" : "no"; };
+    solver_->SetOption("jac_c_constant", yes_no(NlpFormulation::IsJacobianConstant(constraints, true)));
+    solver_->SetOption("jac_d_constant", yes_no(NlpFormulation::IsJacobianConstant(constraints, false)));
+    for (auto c : costs)
       nlp_.AddCostSet(c);
 
     solver_->Solve(nlp_);
@@ -165,16 +183,28 @@ TowrRosInterface::XppVec
 TowrRosInterface::GetTrajectory () const
 {
   XppVec trajectory;
-  double t = 0.0;
   double T = solution.base_linear_->GetTotalTime();
 
+  std::vector<double> times;
+  for (double t=0.0; t<=T+1e-5; t+=visualization_dt_)
+    times.push_back(t);
+
+  // sample each spline at all times at once
+  int n_ee = solution.ee_motion_.size();
+  auto base_lin = solution.base_linear_->GetPoints(times);
+  std::vector<StateSamples<>> ee_motion, ee_force;
+  for (int ee_towr=0; ee_towr<n_ee; ++ee_towr) {
+    ee_motion.push_back(solution.ee_motion_.at(ee_towr)->GetPoints(times));
+    ee_force.push_back(solution.ee_force_.at(ee_towr)->GetPoints(times));
+  }
+
   EulerConverter base_angular(solution.base_angular_);
 
-  while (t<=T+1e-5) {
-    int n_ee = solution.ee_motion_.size();
+  for (int k=0; k<static_cast<int>(times.size()); ++k) {
+    double t = times.at(k);
     xpp::RobotStateCartesian state(n_ee);
 
-    state.base_.lin = ToXpp(solution.base_linear_->GetPoint(t));
+    state.base_.lin = ToXpp(base_lin, k);
 
     state.base_.ang.q  = base_angular.GetQuaternionBaseToWorld(t);
     state.base_.ang.w  = base_angular.GetAngularVelocityInWorld(t);
@@ -184,13 +214,12 @@ TowrRosInterface::GetTrajectory () const
       int ee_xpp = ToXppEndeffector(n_ee, ee_towr).first;
 
       state.ee_contact_.at(ee_xpp) = solution.phase_durations_.at(ee_towr)->IsContactPhase(t);
-      state.ee_motion_.at(ee_xpp)  = ToXpp(solution.ee_motion_.at(ee_towr)->GetPoint(t));
-      state.ee_forces_ .at(ee_xpp) = solution.ee_force_.at(ee_towr)->GetPoint(t).p();
+      state.ee_motion_.at(ee_xpp)  = ToXpp(ee_motion.at(ee_towr), k);
+      state.ee_forces_ .at(ee_xpp) = ee_force.at(ee_towr).p().col(k);
     }
 
     state.t_global_ = t;
     trajectory.push_back(state);
-    t += visualization_dt_;
   }
 
   return trajectory;